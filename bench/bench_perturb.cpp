@@ -0,0 +1,977 @@
+// Rough throughput benchmarks for perturb.
+//
+// Usage: perturb_bench [--json PATH] [TLE_PATH]
+//
+// Run from the build directory so that `SGP4-VER.TLE` can be found, or pass
+// the path to a TLE file. With `--json`, every result is also written to
+// `PATH` in a format similar to Google Benchmark's, for tracking regressions.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "perturb/catalog.hpp"
+#include "perturb/conjunction.hpp"
+#include "perturb/ephemeris.hpp"
+#include "perturb/frames.hpp"
+#include "perturb/observer.hpp"
+#include "perturb/parallel.hpp"
+#include "perturb/perturb.hpp"
+#include "perturb/snapshot.hpp"
+#include "perturb/tle.hpp"
+#include "perturb/tle_reader.hpp"
+
+using namespace perturb;
+
+using Clock = std::chrono::steady_clock;
+
+/// Size of a catalog comparable to the full public catalog
+constexpr std::size_t CATALOG_SIZE = 30000;
+
+/// Load every valid satellite from a TLE file, skipping comment lines
+static std::vector<Satellite> load_satellites(const char *path) {
+    std::vector<Satellite> sats;
+    std::ifstream in_file(path);
+    std::string line_1, line_2;
+    while (std::getline(in_file, line_1)) {
+        if (line_1.empty() || line_1[0] == '#') {
+            continue;
+        }
+        if (!std::getline(in_file, line_2)) {
+            break;
+        }
+        // Chop off any extra verification mode columns
+        line_1.resize(TLE_LINE_LEN);
+        line_2.resize(TLE_LINE_LEN);
+        const auto sat = Satellite::from_tle(line_1, line_2);
+        if (sat.last_error() == Sgp4Error::NONE) {
+            sats.push_back(sat);
+        }
+    }
+    return sats;
+}
+
+/// Repeat the loaded satellites until the catalog is `n` satellites large
+static std::vector<Satellite> make_catalog(
+    const std::vector<Satellite> &sats, std::size_t n
+) {
+    std::vector<Satellite> catalog;
+    catalog.reserve(n);
+    while (catalog.size() < n) {
+        catalog.push_back(sats[catalog.size() % sats.size()]);
+    }
+    return catalog;
+}
+
+/// Run `f` repeatedly and return the fastest seconds per run.
+///
+/// Takes the best of several rounds, each of which lasts at least 0.1 seconds,
+/// as the minimum is the least sensitive to noise from the rest of the system.
+template <typename F>
+static double seconds_per_run(F f) {
+    constexpr int N_ROUNDS = 5;
+    constexpr double MIN_ROUND_SECONDS = 0.1;
+    f();  // Warm-up
+    double best = 0.0;
+    for (int round = 0; round < N_ROUNDS; ++round) {
+        std::size_t runs = 0;
+        const auto start = Clock::now();
+        double elapsed = 0.0;
+        while (elapsed < MIN_ROUND_SECONDS) {
+            f();
+            ++runs;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        const double per_run = elapsed / static_cast<double>(runs);
+        best = (round == 0 || per_run < best) ? per_run : best;
+    }
+    return best;
+}
+
+/// One line of the results, kept for the JSON output
+struct BenchResult {
+    std::string name;
+    double secs_per_run;
+    std::size_t items;
+};
+
+static std::vector<BenchResult> bench_results;
+
+/// Keeps results from being optimized away
+static volatile double checksum_sink = 0.0;
+
+static void report(const char *name, double secs_per_run, std::size_t items) {
+    const double rate = static_cast<double>(items) / secs_per_run;
+    std::printf("%-40s %12.3f ms %14.0f items/s\n", name, secs_per_run * 1e3, rate);
+    bench_results.push_back(BenchResult { name, secs_per_run, items });
+}
+
+/// Write a string as a JSON string literal
+static void write_json_string(std::FILE *file, const char *str) {
+    std::fputc('"', file);
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(*str, file);
+    }
+    std::fputc('"', file);
+}
+
+/// Write every reported result as JSON, with the times in nanoseconds per item
+static bool write_json(const char *path, const char *tle_path, std::size_t n_sats) {
+    std::FILE *file = std::fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+#ifdef NDEBUG
+    const char *build_type = "release";
+#else
+    const char *build_type = "debug";
+#endif
+
+    std::fprintf(file, "{\n  \"context\": {\n    \"date\": ");
+    write_json_string(file, date);
+    std::fprintf(file, ",\n    \"tle_path\": ");
+    write_json_string(file, tle_path);
+    std::fprintf(
+        file,
+        ",\n    \"num_satellites\": %zu,\n    \"catalog_size\": %zu,\n"
+        "    \"library_build_type\": \"%s\"\n  },\n  \"benchmarks\": [",
+        n_sats, CATALOG_SIZE, build_type
+    );
+    for (std::size_t i = 0; i < bench_results.size(); ++i) {
+        const BenchResult &r = bench_results[i];
+        const double items = static_cast<double>(r.items);
+        std::fprintf(file, "%s\n    {\n      \"name\": ", (i == 0) ? "" : ",");
+        write_json_string(file, r.name.c_str());
+        std::fprintf(
+            file,
+            ",\n      \"items\": %zu,\n      \"real_time\": %.3f,\n"
+            "      \"time_unit\": \"ns\",\n      \"items_per_second\": %.1f\n    }",
+            r.items, r.secs_per_run / items * 1e9, items / r.secs_per_run
+        );
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+    return std::fclose(file) == 0;
+}
+
+static void bench_tle_parse(const char *path) {
+    // Pack the TLE lines back to back without terminators, like a file in memory
+    std::vector<char> lines;
+    std::ifstream in_file(path);
+    std::string line;
+    while (std::getline(in_file, line)) {
+        if (line.size() >= TLE_LINE_LEN && (line[0] == '1' || line[0] == '2')) {
+            lines.insert(lines.end(), line.begin(), line.begin() + TLE_LINE_LEN);
+        }
+    }
+    const std::size_t record_len = 2 * TLE_LINE_LEN;
+    const std::size_t n_loaded = lines.size() / record_len;
+    if (n_loaded == 0) {
+        return;
+    }
+    lines.resize(n_loaded * record_len);
+    const std::vector<char> one_copy = lines;
+    while (lines.size() < CATALOG_SIZE * record_len) {
+        lines.insert(lines.end(), one_copy.begin(), one_copy.end());
+    }
+    const std::size_t n_records = lines.size() / record_len;
+
+    std::size_t n_ok = 0;
+    const double secs = seconds_per_run([&]() {
+        n_ok = 0;
+        for (std::size_t i = 0; i < n_records; ++i) {
+            const char *line_1 = lines.data() + i * record_len;
+            TwoLineElement tle;
+            const auto err = tle.parse(
+                line_1, TLE_LINE_LEN, line_1 + TLE_LINE_LEN, TLE_LINE_LEN
+            );
+            n_ok += (err == TLEParseError::NONE) ? 1U : 0U;
+        }
+    });
+    report("TwoLineElement::parse", secs, n_records);
+    const double mb_per_sec = static_cast<double>(lines.size()) / secs / 1e6;
+    std::printf(
+        "%-40s %12.1f MB/s (%zu of %zu valid)\n", "", mb_per_sec, n_ok, n_records
+    );
+}
+
+static void bench_tle_reader(const char *path) {
+    // Write a catalog-sized TLE file by repeating the input, name lines and all
+    std::string text;
+    {
+        std::ifstream in_file(path);
+        std::string line;
+        while (std::getline(in_file, line)) {
+            if (line.size() >= TLE_LINE_LEN && (line[0] == '1' || line[0] == '2')) {
+                text.append(line, 0, TLE_LINE_LEN).push_back('\n');
+            }
+        }
+    }
+    const std::size_t n_loaded = text.size() / (2 * (TLE_LINE_LEN + 1));
+    if (n_loaded == 0) {
+        return;
+    }
+    const std::string one_copy = text;
+    while (text.size() / (2 * (TLE_LINE_LEN + 1)) < CATALOG_SIZE) {
+        text += one_copy;
+    }
+    const std::size_t n_records = text.size() / (2 * (TLE_LINE_LEN + 1));
+    const char *catalog_path = "perturb_bench_catalog.tle";
+    std::ofstream(catalog_path, std::ios::binary) << text;
+
+    const double getline_secs = seconds_per_run([&]() {
+        std::vector<Satellite> sats;
+        std::ifstream in_file(catalog_path);
+        std::string line_1, line_2;
+        while (std::getline(in_file, line_1) && std::getline(in_file, line_2)) {
+            const auto sat = Satellite::from_tle(line_1, line_2);
+            if (sat.last_error() == Sgp4Error::NONE) {
+                sats.push_back(sat);
+            }
+        }
+    });
+    report("getline + Satellite::from_tle", getline_secs, n_records);
+
+    for (const std::size_t n_threads : { 1U, 0U }) {
+        const double secs = seconds_per_run([&]() {
+            std::vector<Satellite> sats;
+            std::vector<TleReadResult> results;
+            const TleReader reader(catalog_path);
+            (void) reader.read(sats, results, GravModel::WGS72, n_threads);
+        });
+        const char *name = (n_threads == 1) ? "TleReader::read (1 thread)"
+                                            : "TleReader::read (all threads)";
+        report(name, secs, n_records);
+    }
+    std::remove(catalog_path);
+}
+
+static void bench_init_satellites(const char *path) {
+    std::vector<TwoLineElement> tles;
+    std::ifstream in_file(path);
+    std::string line_1, line_2;
+    while (std::getline(in_file, line_1)) {
+        if (line_1.empty() || line_1[0] == '#' || !std::getline(in_file, line_2)) {
+            continue;
+        }
+        TwoLineElement tle {};
+        if (tle.parse(line_1, line_2) == TLEParseError::NONE) {
+            tles.push_back(tle);
+        }
+    }
+    if (tles.empty()) {
+        return;
+    }
+    const std::size_t n_loaded = tles.size();
+    while (tles.size() < CATALOG_SIZE) {
+        tles.push_back(tles[tles.size() % n_loaded]);
+    }
+
+    const double serial = seconds_per_run([&]() {
+        std::vector<Satellite> sats;
+        sats.reserve(tles.size());
+        for (const auto &tle : tles) {
+            sats.push_back(Satellite(tle));
+        }
+    });
+    report("Satellite(tle) (scalar loop)", serial, tles.size());
+
+    for (const std::size_t n_threads : { 1U, 0U }) {
+        const double secs = seconds_per_run([&]() {
+            std::vector<Satellite> sats;
+            (void) init_satellites(
+                tles.data(), tles.size(), sats, nullptr, GravModel::WGS72, n_threads
+            );
+        });
+        const char *name = (n_threads == 1) ? "init_satellites (1 thread)"
+                                            : "init_satellites (all threads)";
+        report(name, secs, tles.size());
+    }
+}
+
+static void bench_sgp4init(const std::vector<Satellite> &sats) {
+    // Initialize copies of the loaded records again, split by the method
+    // `sgp4init` picks, since deep-space initialization does a lot more
+    for (const char method : { 'n', 'd' }) {
+        std::vector<sgp4::elsetrec> recs;
+        for (const auto &sat : sats) {
+            if (sat.sat_rec.method == method) {
+                recs.push_back(sat.sat_rec);
+            }
+        }
+        if (recs.empty()) {
+            continue;
+        }
+        const double secs = seconds_per_run([&]() {
+            for (auto &rec : recs) {
+                char satnum[sizeof(rec.satnum)];
+                std::memcpy(satnum, rec.satnum, sizeof(satnum));
+                const double epoch = (rec.jdsatepoch + rec.jdsatepochF) - 2433281.5;
+                (void) sgp4::sgp4init(
+                    sgp4::wgs72, 'i', satnum, epoch, rec.bstar, rec.ndot, rec.nddot,
+                    rec.ecco, rec.argpo, rec.inclo, rec.mo, rec.no_kozai, rec.nodeo, rec
+                );
+            }
+        });
+        const char *name =
+            (method == 'n') ? "sgp4init (near-Earth)" : "sgp4init (deep-space)";
+        report(name, secs, recs.size());
+    }
+}
+
+static void bench_propagate_offsets(const std::vector<Satellite> &sats) {
+    // Each call starts from epoch, so the deep-space resonance integrator
+    // takes longer the further away the time is
+    const struct {
+        const char *name;
+        char method;
+        bool resonant;
+    } groups[] = {
+        { "near-Earth", 'n', false },
+        { "deep-space", 'd', false },
+        { "resonant", 'd', true },
+    };
+    const struct {
+        const char *name;
+        double days;
+    } offsets[] = {
+        { "epoch", 0.0 },
+        { "+1 d", 1.0 },
+        { "+30 d", 30.0 },
+        { "+365 d", 365.0 },
+    };
+    for (const auto &group : groups) {
+        std::vector<Satellite> group_sats;
+        for (const auto &sat : sats) {
+            const bool resonant = (sat.sat_rec.irez != 0);
+            if (sat.sat_rec.method == group.method && resonant == group.resonant) {
+                group_sats.push_back(sat);
+            }
+        }
+        if (group_sats.empty()) {
+            continue;
+        }
+        for (const auto &offset : offsets) {
+            const double secs = seconds_per_run([&]() {
+                double sum = 0.0;
+                for (const auto &sat : group_sats) {
+                    StateVector sv;
+                    (void) sat.propagate(sat.epoch() + offset.days, sv);
+                    sum += sv.position[0];
+                }
+                checksum_sink = sum;
+            });
+            char name[64];
+            std::snprintf(
+                name, sizeof(name), "propagate (%s, %s)", group.name, offset.name
+            );
+            report(name, secs, group_sats.size());
+        }
+    }
+}
+
+static void bench_julian_date() {
+    constexpr std::size_t N_DATES = 10000;
+    std::vector<DateTime> dates(N_DATES);
+    for (std::size_t i = 0; i < N_DATES; ++i) {
+        const auto k = static_cast<int>(i);
+        dates[i] = DateTime {
+            1990 + k % 40, 1 + k % 12, 1 + k % 28, k % 24, k % 60, (k % 600) / 10.0
+        };
+    }
+    std::vector<JulianDate> jds(N_DATES);
+
+    const double to_jd = seconds_per_run([&]() {
+        for (std::size_t i = 0; i < N_DATES; ++i) {
+            jds[i] = JulianDate(dates[i]);
+        }
+    });
+    report("JulianDate(DateTime)", to_jd, N_DATES);
+
+    const double to_dt = seconds_per_run([&]() {
+        double sum = 0.0;
+        for (const auto &jd : jds) {
+            sum += jd.to_datetime().sec;
+        }
+        checksum_sink = sum;
+    });
+    report("JulianDate::to_datetime", to_dt, N_DATES);
+
+    const double normalize = seconds_per_run([&]() {
+        double sum = 0.0;
+        for (const auto &jd : jds) {
+            sum += (jd + 0.75).normalized().jd_frac;
+        }
+        checksum_sink = sum;
+    });
+    report("JulianDate::normalized", normalize, N_DATES);
+}
+
+static void bench_orbital_elements(const std::vector<Satellite> &sats) {
+    std::vector<StateVector> states;
+    for (const auto &sat : sats) {
+        StateVector sv;
+        if (sat.propagate(sat.epoch() + 1.5, sv) == Sgp4Error::NONE) {
+            states.push_back(sv);
+        }
+    }
+    if (states.empty()) {
+        return;
+    }
+    const std::size_t n_loaded = states.size();
+    while (states.size() < CATALOG_SIZE) {
+        states.push_back(states[states.size() % n_loaded]);
+    }
+    const double secs = seconds_per_run([&]() {
+        double sum = 0.0;
+        for (const auto &sv : states) {
+            sum += ClassicalOrbitalElements(sv).eccentricity;
+        }
+        checksum_sink = sum;
+    });
+    report("ClassicalOrbitalElements", secs, states.size());
+}
+
+static void bench_snapshot(const std::vector<Satellite> &sats) {
+    const auto catalog = make_catalog(sats, CATALOG_SIZE);
+    const char *snapshot_path = "perturb_bench_catalog.snap";
+    if (write_snapshot(snapshot_path, catalog.data(), catalog.size())
+        != SnapshotError::NONE) {
+        return;
+    }
+    // Includes the first propagation, to count any page faults from the mapping
+    for (const bool verify : { true, false }) {
+        const double secs = seconds_per_run([&]() {
+            Snapshot snap;
+            (void) snap.open(snapshot_path, GravModel::WGS72, verify);
+            StateVector sv;
+            (void) snap[0].propagate(snap[0].epoch(), sv);
+        });
+        const char *name = verify ? "Snapshot::open (checksum)"
+                                  : "Snapshot::open (no checksum)";
+        report(name, secs, catalog.size());
+    }
+    std::remove(snapshot_path);
+}
+
+static void bench_propagate_batch(const std::vector<Satellite> &sats) {
+    auto catalog = make_catalog(sats, CATALOG_SIZE);
+    std::vector<StateVector> out_sv(catalog.size());
+    std::vector<Sgp4Error> out_err(catalog.size());
+    const JulianDate jd = catalog.front().epoch() + 1.5;
+
+    const double scalar = seconds_per_run([&]() {
+        for (std::size_t i = 0; i < catalog.size(); ++i) {
+            out_err[i] = catalog[i].propagate(jd, out_sv[i]);
+        }
+    });
+    report("propagate (scalar loop)", scalar, catalog.size());
+
+    const double batch = seconds_per_run([&]() {
+        (void) propagate_batch(
+            catalog.data(), catalog.size(), jd, out_sv.data(), out_err.data()
+        );
+    });
+    report("propagate_batch", batch, catalog.size());
+
+    auto soa_catalog = SatelliteCatalog(catalog);
+    const double soa = seconds_per_run([&]() {
+        (void) soa_catalog.propagate(jd, out_sv.data(), out_err.data());
+    });
+    report("SatelliteCatalog::propagate", soa, soa_catalog.size());
+}
+
+static void bench_catalog_near_earth(const std::vector<Satellite> &sats) {
+    // Only keep satellites that propagate cleanly, since erroring ones return
+    // early in the scalar code and would make the comparison lopsided
+    const JulianDate jd = sats.front().epoch() + 1.5;
+    std::vector<Satellite> near_sats;
+    for (auto sat : sats) {
+        StateVector sv;
+        if (sat.sat_rec.method == 'n' && sat.propagate(jd, sv) == Sgp4Error::NONE) {
+            near_sats.push_back(sat);
+        }
+    }
+    if (near_sats.empty()) {
+        return;
+    }
+    auto catalog = make_catalog(near_sats, CATALOG_SIZE);
+    std::vector<StateVector> out_sv(catalog.size());
+    std::vector<Sgp4Error> out_err(catalog.size());
+
+    const double batch = seconds_per_run([&]() {
+        (void) propagate_batch(
+            catalog.data(), catalog.size(), jd, out_sv.data(), out_err.data()
+        );
+    });
+    report("propagate_batch (near-Earth only)", batch, catalog.size());
+
+    auto soa_catalog = SatelliteCatalog(catalog);
+    const double soa = seconds_per_run([&]() {
+        (void) soa_catalog.propagate(jd, out_sv.data(), out_err.data());
+    });
+    report("SatelliteCatalog (near-Earth only)", soa, soa_catalog.size());
+
+    const double mixed = seconds_per_run([&]() {
+        (void) soa_catalog.propagate(
+            jd, out_sv.data(), out_err.data(), CatalogPrecision::MIXED
+        );
+    });
+    report("SatelliteCatalog (near-Earth, mixed)", mixed, soa_catalog.size());
+    std::printf("  %.2fx faster in mixed precision\n", soa / mixed);
+}
+
+static void bench_catalog_deep_space(const std::vector<Satellite> &sats) {
+    const JulianDate jd = sats.front().epoch() + 1.5;
+    std::vector<Satellite> deep_sats;
+    for (auto sat : sats) {
+        StateVector sv;
+        if (sat.sat_rec.method == 'd' && sat.propagate(jd, sv) == Sgp4Error::NONE) {
+            deep_sats.push_back(sat);
+        }
+    }
+    if (deep_sats.empty()) {
+        return;
+    }
+    auto catalog = make_catalog(deep_sats, CATALOG_SIZE);
+    std::vector<StateVector> out_sv(catalog.size());
+    std::vector<Sgp4Error> out_err(catalog.size());
+
+    const double scalar = seconds_per_run([&]() {
+        for (std::size_t i = 0; i < catalog.size(); ++i) {
+            out_err[i] = catalog[i].propagate(jd, out_sv[i]);
+        }
+    });
+    report("propagate (deep-space only)", scalar, catalog.size());
+
+    auto soa_catalog = SatelliteCatalog(catalog);
+    const double soa = seconds_per_run([&]() {
+        (void) soa_catalog.propagate(jd, out_sv.data(), out_err.data());
+    });
+    report("SatelliteCatalog (deep-space only)", soa, soa_catalog.size());
+}
+
+static void bench_propagate_range(const std::vector<Satellite> &sats) {
+    // Every 10 seconds for a day, starting at each satellite's own epoch
+    constexpr double STEP_SEC = 10.0;
+    constexpr std::size_t COUNT = 8640;
+    std::vector<StateVector> out_sv(COUNT);
+    for (const char method : { 'n', 'd' }) {
+        // First satellite of this kind that makes it through the whole day
+        const Satellite *sat = nullptr;
+        for (const auto &candidate : sats) {
+            std::size_t n_valid = 0;
+            if (candidate.sat_rec.method == method) {
+                (void) candidate.propagate_range(
+                    candidate.epoch(), STEP_SEC, COUNT, out_sv.data(), &n_valid
+                );
+            }
+            if (n_valid == COUNT) {
+                sat = &candidate;
+                break;
+            }
+        }
+        if (!sat) {
+            continue;
+        }
+        Satellite naive_sat = *sat;
+        const JulianDate start = sat->epoch();
+
+        const double naive = seconds_per_run([&]() {
+            for (std::size_t k = 0; k < COUNT; ++k) {
+                const double days = static_cast<double>(k) * STEP_SEC / 86400.0;
+                (void) naive_sat.propagate(start + days, out_sv[k]);
+            }
+        });
+        const double range = seconds_per_run([&]() {
+            (void) sat->propagate_range(start, STEP_SEC, COUNT, out_sv.data());
+        });
+        const bool near = (method == 'n');
+        report(
+            near ? "propagate loop (near-Earth)" : "propagate loop (deep-space)", naive,
+            COUNT
+        );
+        report(
+            near ? "propagate_range (near-Earth)" : "propagate_range (deep-space)",
+            range, COUNT
+        );
+    }
+}
+
+static void bench_resonance_checkpoints(const std::vector<Satellite> &sats) {
+    // Random-order queries within a year either side of epoch
+    constexpr std::size_t N_QUERIES = 1000;
+    constexpr double MAX_DAYS = 365.0;
+    const Satellite *sat = nullptr;
+    for (const auto &candidate : sats) {
+        const JulianDate epoch = candidate.epoch();
+        StateVector sv;
+        if (candidate.sat_rec.method == 'd' && candidate.sat_rec.irez != 0
+            && candidate.propagate(epoch + MAX_DAYS, sv) == Sgp4Error::NONE
+            && candidate.propagate(epoch - MAX_DAYS, sv) == Sgp4Error::NONE) {
+            sat = &candidate;
+            break;
+        }
+    }
+    if (!sat) {
+        return;
+    }
+    std::vector<JulianDate> times;
+    std::uint32_t lcg = 12345;
+    for (std::size_t k = 0; k < N_QUERIES; ++k) {
+        lcg = lcg * 1664525U + 1013904223U;
+        const double frac = static_cast<double>(lcg) / 4294967296.0;
+        times.push_back(sat->epoch() + (2.0 * frac - 1.0) * MAX_DAYS);
+    }
+    StateVector sv;
+
+    Satellite mut_sat = *sat;
+    const double mutating = seconds_per_run([&]() {
+        for (const auto &jd : times) {
+            (void) mut_sat.propagate(jd, sv);
+        }
+    });
+    report("propagate (random order, resonant)", mutating, N_QUERIES);
+
+    const double checkpointed = seconds_per_run([&]() {
+        ResonanceCheckpoints checkpoints;
+        sgp4::elsetrec_state state {};
+        for (const auto &jd : times) {
+            (void) sat->propagate(jd, sv, state, checkpoints);
+        }
+    });
+    report("propagate (random order, checkpoints)", checkpointed, N_QUERIES);
+}
+
+static void bench_frames(const std::vector<Satellite> &sats) {
+    auto catalog = SatelliteCatalog(make_catalog(sats, CATALOG_SIZE));
+    std::vector<StateVector> teme(catalog.size());
+    std::vector<Sgp4Error> err(catalog.size());
+    (void) catalog.propagate(catalog[0].epoch() + 1.5, teme.data(), err.data());
+    std::vector<EcefState> ecef(catalog.size());
+    std::vector<Geodetic> geo(catalog.size());
+
+    const double scalar = seconds_per_run([&]() {
+        for (std::size_t i = 0; i < teme.size(); ++i) {
+            ecef[i] = to_ecef(teme[i]);
+        }
+    });
+    report("to_ecef (scalar loop)", scalar, teme.size());
+
+    const double batch = seconds_per_run([&]() {
+        to_ecef(teme.data(), teme.size(), ecef.data());
+    });
+    report("to_ecef (batch)", batch, teme.size());
+
+    const double geodetic = seconds_per_run([&]() {
+        for (std::size_t i = 0; i < ecef.size(); ++i) {
+            geo[i] = to_geodetic(ecef[i].position);
+        }
+    });
+    report("to_geodetic (from ECEF)", geodetic, ecef.size());
+
+    const double batch_geodetic = seconds_per_run([&]() {
+        to_geodetic(teme.data(), teme.size(), geo.data());
+    });
+    report("to_geodetic (batch, from TEME)", batch_geodetic, teme.size());
+}
+
+static void bench_look_angles(const std::vector<Satellite> &sats) {
+    constexpr int N_STATIONS = 40;
+    auto catalog = SatelliteCatalog(make_catalog(sats, CATALOG_SIZE));
+    const JulianDate jd = catalog[0].epoch() + 1.5;
+    std::vector<StateVector> teme(catalog.size());
+    std::vector<Sgp4Error> err(catalog.size());
+    (void) catalog.propagate(jd, teme.data(), err.data());
+
+    StationNetwork network;
+    for (int i = 0; i < N_STATIONS; ++i) {
+        const double lat = (-60.0 + 3.0 * i) * 3.14159265358979 / 180.0;
+        const double lon = (-180.0 + 9.0 * i) * 3.14159265358979 / 180.0;
+        network.add(GroundStation(Geodetic { lat, lon, 0.0 }, 0.1));
+    }
+    const std::size_t n_pairs = network.size() * teme.size();
+    std::vector<Visibility> out;
+    out.reserve(n_pairs);
+
+    // The usual hand-written loop, converting and looking at every pair
+    std::vector<EcefState> ecef(teme.size());
+    const double scalar = seconds_per_run([&]() {
+        out.clear();
+        to_ecef(teme.data(), teme.size(), ecef.data());
+        for (std::size_t s = 0; s < network.size(); ++s) {
+            for (std::size_t i = 0; i < ecef.size(); ++i) {
+                const LookAngles look = network[s].look_at(ecef[i]);
+                if (err[i] == Sgp4Error::NONE
+                    && look.elevation >= network[s].min_elevation()) {
+                    out.push_back(Visibility { s, i, look });
+                }
+            }
+        }
+    });
+    report("look_at (scalar loop over pairs)", scalar, n_pairs);
+
+    const double kernel = seconds_per_run([&]() {
+        out.clear();
+        (void) network.look_angles(teme.data(), teme.size(), err.data(), out);
+    });
+    report("StationNetwork::look_angles", kernel, n_pairs);
+    std::printf("  %zu of %zu pairs visible\n", out.size(), n_pairs);
+}
+
+static void bench_find_passes(const std::vector<Satellite> &sats) {
+    constexpr double WINDOW_DAYS = 7.0;
+    constexpr double SCAN_STEP_SECS = 10.0;
+    const GroundStation station(Geodetic { 0.8, -1.3, 0.1 }, 0.1);
+
+    // Scan every satellite at a fixed step, only noting when each pass starts
+    std::size_t scan_evals = 0, scan_passes = 0;
+    const double scan = seconds_per_run([&]() {
+        scan_evals = scan_passes = 0;
+        for (const Satellite &sat : sats) {
+            const JulianDate start = sat.epoch();
+            bool in_pass = false;
+            for (double t = 0.0; t < WINDOW_DAYS * 86400.0; t += SCAN_STEP_SECS) {
+                const JulianDate jd = start + t / 86400.0;
+                StateVector sv;
+                ++scan_evals;
+                if (sat.propagate(jd, sv) != Sgp4Error::NONE) {
+                    break;
+                }
+                const EcefState ecef = EarthRotation(jd).to_ecef(sv);
+                const bool visible = station.look_at(ecef).elevation >= 0.1;
+                scan_passes += (visible && !in_pass) ? 1 : 0;
+                in_pass = visible;
+            }
+        }
+    });
+    report("fixed 10 s scan (7 days)", scan, sats.size());
+    std::printf("  %zu passes, %zu propagations\n", scan_passes, scan_evals);
+
+    std::size_t search_evals = 0, search_passes = 0;
+    std::vector<Pass> passes;
+    const double search = seconds_per_run([&]() {
+        search_evals = search_passes = 0;
+        for (const Satellite &sat : sats) {
+            passes.clear();
+            std::size_t n_evals = 0;
+            (void) find_passes(
+                sat, station, sat.epoch(), sat.epoch() + WINDOW_DAYS, passes, &n_evals
+            );
+            search_evals += n_evals;
+            search_passes += passes.size();
+        }
+    });
+    report("find_passes (7 days)", search, sats.size());
+    std::printf("  %zu passes, %zu propagations\n", search_passes, search_evals);
+}
+
+#ifndef PERTURB_DISABLE_THREADS
+static void bench_parallel_propagator(const std::vector<Satellite> &sats) {
+    // A smaller version of a full catalog over a day at one minute steps
+    constexpr std::size_t N_SATS = 1000;
+    constexpr std::size_t N_TIMES = 1440;
+    auto catalog = SatelliteCatalog(make_catalog(sats, N_SATS));
+    std::vector<JulianDate> times;
+    for (std::size_t k = 0; k < N_TIMES; ++k) {
+        times.push_back(sats.front().epoch() + static_cast<double>(k) / 1440.0);
+    }
+    std::vector<StateVector> out_sv(N_SATS * N_TIMES);
+    std::vector<Sgp4Error> out_err(N_SATS * N_TIMES);
+
+    const double single = seconds_per_run([&]() {
+        (void) catalog.propagate_grid(
+            0, catalog.size(), times.data(), times.size(), out_sv.data(), out_err.data()
+        );
+    });
+    report("propagate_grid (1 thread)", single, out_sv.size());
+
+    ParallelPropagator propagator;
+    const double parallel = seconds_per_run([&]() {
+        (void) propagator.propagate(
+            catalog, times.data(), times.size(), out_sv.data(), out_err.data()
+        );
+    });
+    char name[64];
+    std::snprintf(
+        name, sizeof(name), "ParallelPropagator (%zu threads)", propagator.thread_count()
+    );
+    report(name, parallel, out_sv.size());
+}
+#endif  // PERTURB_DISABLE_THREADS
+
+/// A random population of `n` satellites with orbits from low to medium Earth,
+/// since copies of a few satellites would all be on top of each other
+static std::vector<Satellite> make_population(std::size_t n) {
+    std::uint32_t seed = 12345;
+    const auto uniform = [&seed](const double lo, const double hi) {
+        seed = seed * 1664525U + 1013904223U;
+        return lo + (hi - lo) * static_cast<double>(seed >> 8) / 16777216.0;
+    };
+    std::vector<Satellite> sats;
+    sats.reserve(n);
+    while (sats.size() < n) {
+        TwoLineElement tle {};
+        std::strcpy(tle.catalog_number, "99999");
+        tle.classification = 'U';
+        tle.epoch_year = 22U;
+        tle.epoch_day_of_year = 100.5;
+        tle.b_star = 1e-5;
+        tle.inclination = uniform(0.0, 110.0);
+        tle.raan = uniform(0.0, 360.0);
+        tle.eccentricity = uniform(0.0, 1.0) * uniform(0.0, 0.05);
+        tle.arg_of_perigee = uniform(0.0, 360.0);
+        tle.mean_anomaly = uniform(0.0, 360.0);
+        // Mostly low Earth orbits, as in the real catalog
+        tle.mean_motion = (uniform(0.0, 1.0) < 0.9) ? uniform(13.0, 15.5)
+                                                    : uniform(2.0, 13.0);
+        sats.emplace_back(tle);
+    }
+    return sats;
+}
+
+static void bench_ephemeris(const std::vector<Satellite> &sats) {
+    constexpr double WINDOW_DAYS = 1.0;
+    constexpr std::size_t N_QUERIES = 100000;
+    std::vector<Ephemeris> ephs;
+    const double fit = seconds_per_run([&]() {
+        ephs.clear();
+        for (const Satellite &sat : sats) {
+            ephs.emplace_back(sat, sat.epoch(), sat.epoch() + WINDOW_DAYS);
+        }
+    });
+    std::size_t n_segments = 0;
+    for (const Ephemeris &eph : ephs) {
+        n_segments += eph.size();
+    }
+    report("Ephemeris fit (1 day, 1 m)", fit, sats.size());
+    std::printf("  %zu segments\n", n_segments);
+
+    // Queries at scattered times inside the window, like random access
+    std::vector<double> offsets(N_QUERIES);
+    std::uint32_t seed = 12345;
+    for (double &offset : offsets) {
+        seed = seed * 1664525U + 1013904223U;
+        offset = WINDOW_DAYS * static_cast<double>(seed >> 8) / 16777216.0;
+    }
+    double sink = 0.0;
+    const double direct = seconds_per_run([&]() {
+        StateVector sv;
+        for (std::size_t k = 0; k < N_QUERIES; ++k) {
+            const Satellite &sat = sats[k % sats.size()];
+            (void) sat.propagate(sat.epoch() + offsets[k], sv);
+            sink += sv.position[0];
+        }
+    });
+    report("Satellite::propagate (random times)", direct, N_QUERIES);
+    const double interp = seconds_per_run([&]() {
+        StateVector sv;
+        for (std::size_t k = 0; k < N_QUERIES; ++k) {
+            const Ephemeris &eph = ephs[k % ephs.size()];
+            (void) eph.propagate(eph.start() + offsets[k], sv);
+            sink += sv.position[0];
+        }
+    });
+    report("Ephemeris::propagate (random times)", interp, N_QUERIES);
+    std::printf("  %.1fx faster (checksum %g)\n", direct / interp, sink);
+}
+
+static void bench_conjunctions() {
+    constexpr double WINDOW_SECS = 600.0;
+    constexpr double STEP_SECS = 30.0;
+    constexpr double THRESHOLD = 10.0;
+    const SatelliteCatalog catalog(make_population(CATALOG_SIZE));
+    const JulianDate start = catalog[0].epoch();
+    const JulianDate end = start + WINDOW_SECS / 86400.0;
+    const auto n_steps = static_cast<std::size_t>(WINDOW_SECS / STEP_SECS) + 1;
+
+    // Checking every pair at a single step, for comparison
+    std::vector<StateVector> sv(catalog.size());
+    std::vector<Sgp4Error> err(catalog.size());
+    catalog.propagate_grid(0, catalog.size(), &start, 1, sv.data(), err.data());
+    std::size_t n_close = 0;
+    const double all_pairs = seconds_per_run([&]() {
+        n_close = 0;
+        for (std::size_t i = 0; i < sv.size(); ++i) {
+            for (std::size_t j = i + 1; j < sv.size(); ++j) {
+                const double dx = sv[j].position[0] - sv[i].position[0];
+                const double dy = sv[j].position[1] - sv[i].position[1];
+                const double dz = sv[j].position[2] - sv[i].position[2];
+                n_close += (dx * dx + dy * dy + dz * dz <= THRESHOLD * THRESHOLD);
+            }
+        }
+    });
+    report("all pairs distances (1 step)", all_pairs, catalog.size());
+    std::printf("  %zu pairs within %.0f km\n", n_close, THRESHOLD);
+
+    for (const std::size_t n_threads : { std::size_t {1}, std::size_t {0} }) {
+        std::vector<Conjunction> out;
+        const double secs = seconds_per_run([&]() {
+            out.clear();
+            (void) screen_conjunctions(
+                catalog, start, end, THRESHOLD, out, STEP_SECS, n_threads
+            );
+        });
+        const char *name = (n_threads == 1) ? "screen_conjunctions, per step (1 thread)"
+                                            : "screen_conjunctions, per step (all)";
+        report(name, secs / static_cast<double>(n_steps), catalog.size());
+        std::printf("  %zu conjunctions in %.0f s\n", out.size(), WINDOW_SECS);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *tle_path = "SGP4-VER.TLE";
+    const char *json_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            tle_path = argv[i];
+        }
+    }
+    const auto sats = load_satellites(tle_path);
+    if (sats.empty()) {
+        std::fprintf(stderr, "No satellites loaded from '%s'\n", tle_path);
+        return 1;
+    }
+    std::printf("Loaded %zu satellites from '%s'\n", sats.size(), tle_path);
+
+    bench_tle_parse(tle_path);
+    bench_tle_reader(tle_path);
+    bench_init_satellites(tle_path);
+    bench_sgp4init(sats);
+    bench_julian_date();
+    bench_orbital_elements(sats);
+    bench_snapshot(sats);
+    bench_propagate_offsets(sats);
+    bench_propagate_batch(sats);
+    bench_catalog_near_earth(sats);
+    bench_catalog_deep_space(sats);
+    bench_propagate_range(sats);
+    bench_resonance_checkpoints(sats);
+    bench_frames(sats);
+    bench_look_angles(sats);
+    bench_find_passes(sats);
+    bench_conjunctions();
+    bench_ephemeris(sats);
+#ifndef PERTURB_DISABLE_THREADS
+    bench_parallel_propagator(sats);
+#endif
+
+    if (json_path && !write_json(json_path, tle_path, sats.size())) {
+        std::fprintf(stderr, "Couldn't write results to '%s'\n", json_path);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,328 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for propagating large catalogs of satellites together
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_CATALOG_HPP
+#define PERTURB_CATALOG_HPP
+
+#include "perturb/perturb.hpp"
+#include "perturb/stats.hpp"
+#include "perturb/tle.hpp"
+#ifndef PERTURB_DISABLE_IO
+#  include "perturb/tle_reader.hpp"
+#endif
+
+#include <cstddef>
+#include <vector>
+
+namespace perturb {
+
+/// Number of near-Earth satellites propagated together by `SatelliteCatalog`
+constexpr std::size_t CATALOG_LANES = 8;
+
+/// Floating-point precision of the near-Earth kernel of `SatelliteCatalog`
+enum class CatalogPrecision {
+    DOUBLE,  ///< Double precision, same as `perturb::sgp4::sgp4` to within rounding
+    MIXED,   ///< Single precision past the angle reduction, see `SatelliteCatalog`
+};
+
+/// Caller-owned output columns for a whole catalog at one time point.
+///
+/// Satellite `i` of the catalog goes in element `i * stride` of each column.
+/// With a stride of 1, these are separate structure-of-arrays columns, ready
+/// for SIMD post-processing or columnar export without a transpose. With a
+/// stride of 6 and the pointers offset into one array, they're interleaved
+/// rows of `x, y, z, vx, vy, vz` instead. Any column can be `nullptr` to leave
+/// it out, like the velocity when only positions are needed. There's no
+/// time-stamp column, since every satellite is at the time point passed to
+/// `SatelliteCatalog::propagate`.
+struct StateColumns {
+    double *x = nullptr;     ///< Position x in the TEME frame in [km]
+    double *y = nullptr;     ///< Position y in the TEME frame in [km]
+    double *z = nullptr;     ///< Position z in the TEME frame in [km]
+    double *vx = nullptr;    ///< Velocity x in the TEME frame in [km/s]
+    double *vy = nullptr;    ///< Velocity y in the TEME frame in [km/s]
+    double *vz = nullptr;    ///< Velocity z in the TEME frame in [km/s]
+    std::size_t stride = 1;  ///< Elements from one satellite to the next
+};
+
+/// A collection of satellites laid out for fast propagation to shared times.
+///
+/// Unlike the rest of the library, this type uses dynamic memory. Every added
+/// `Satellite` is kept as-is, but the coefficients used by near-Earth
+/// (`method == 'n'`) satellites are also copied into structure-of-arrays
+/// columns. Propagation then runs the near-Earth SGP4 equations over blocks
+/// of `CATALOG_LANES` satellites at a time, with every step written
+/// as a fixed-width loop over the lanes. This lets the compiler map each step
+/// onto SIMD registers (e.g. 4 doubles for AVX2 or 8 for AVX-512), given the
+/// right flags like `-O3 -march=native`. Deep-space satellites run the part
+/// before the Kepler solve one by one, where the lunar-solar terms and the
+/// resonance integrator branch too much to batch, then go through the same
+/// lanes for the rest. They're propagated from a
+/// `perturb::sgp4::elsetrec_compact` copy of their record, which leaves out
+/// the TLE metadata and everything only needed for initialization. So the
+/// propagation data (hot) is kept apart from the full satellites (cold), which
+/// are only looked at through `operator[]`.
+///
+/// The Kepler solve iterates all lanes together, with converged lanes masked
+/// off, and with a sine and cosine that vectorize instead of the math library
+/// calls. Unlike the Newton iterations of `perturb::sgp4::sgp4`, each one is a
+/// Halley step, which converges cubically for the same sine and cosine. On
+/// `SGP4-VER.TLE`, that takes near-Earth satellites from 3 iterations down to
+/// 2, and deep-space satellites with an eccentricity above 0.5 from 5.4 down to
+/// 3.6 on average. It also converges past the 1e-12 rad where the original
+/// stops, so otherwise following the original operation for operation, the
+/// results agree with `perturb::sgp4::sgp4` to within about 1e-12 relative
+/// error. The scalar functions keep the original solver, so they still match
+/// the reference implementation exactly.
+///
+/// For workloads like visualization or first-pass screening, the kernel can
+/// instead run in `CatalogPrecision::MIXED`. The time since epoch, the secular
+/// and drag updates, and the reduction of the angles to [0, 2pi) stay in
+/// double, since those grow without bound. The Kepler solve and the periodics
+/// after it, where most of the work is, run in single precision, which fits
+/// twice as many lanes in each SIMD register. Against double on the near-Earth
+/// satellites of `SGP4-VER.TLE`, over their whole verification time ranges,
+/// positions agree to within 15 m and velocities to within 15 mm/s (about
+/// 2 m on average), most of it from rounding the anomaly to a float near
+/// 2pi. With the default release flags on x86-64, it's about 1.25x the
+/// throughput of double, since the math library calls stay scalar, so
+/// measure the build at hand with `perturb_bench`. Deep-space satellites always
+/// use double.
+///
+/// If every near-Earth satellite has the exact gravity constants of one
+/// `GravModel`, which is the usual case, the kernel is specialized on it with
+/// `GravConstants`. Then `xke`, `j2`, and the Earth radius are immediates
+/// instead of loads, and they aren't stored per satellite at all.
+class SatelliteCatalog {
+public:
+    /// Construct an empty catalog
+    SatelliteCatalog();
+
+    /// Construct a catalog from a list of initialized satellites.
+    ///
+    /// @param sats Initialized satellites, kept in the same order
+    explicit SatelliteCatalog(const std::vector<Satellite> &sats);
+
+#ifndef PERTURB_DISABLE_IO
+    /// Load every valid satellite from a 2-line or 3-line TLE file.
+    ///
+    /// This is a shortcut for `TleReader::read` followed by the
+    /// `SatelliteCatalog(const std::vector<Satellite> &)` constructor. If the
+    /// file can't be opened, the catalog and results are empty, so use a
+    /// `TleReader` directly to tell that apart from an empty file.
+    ///
+    /// @param path Path to the TLE file
+    /// @param out_results One result per TLE record in the file, or `nullptr`
+    /// @param grav_model Gravity constants to use (default `GravModel::WGS72`)
+    /// @param n_threads Number of threads, or 0 to use the hardware concurrency
+    /// @return Catalog of every satellite that parsed and initialized without error
+    static SatelliteCatalog load(
+        const char *path, std::vector<TleReadResult> *out_results = nullptr,
+        GravModel grav_model = GravModel::WGS72, std::size_t n_threads = 0
+    );
+#endif  // PERTURB_DISABLE_IO
+
+    /// Add an initialized satellite to the end of the catalog.
+    ///
+    /// @param sat Initialized satellite, copied into the catalog
+    void add(const Satellite &sat);
+
+    /// Number of satellites in the catalog
+    std::size_t size() const;
+
+    /// Number of satellites that use the near-Earth vectorized kernel
+    std::size_t near_earth_size() const;
+
+    /// Access a satellite by its index in the catalog
+    const Satellite &operator[](std::size_t i) const;
+
+    /// Gravity model shared by every near-Earth satellite, if there is one.
+    ///
+    /// @param out Returned gravity model, left as-is if there isn't one
+    /// @return If the near-Earth kernel is specialized on a single model
+    bool grav_model(GravModel &out) const;
+
+    /// Propagation statistics of one satellite, if `PERTURB_ENABLE_STATS` is defined.
+    ///
+    /// Counts every `SatelliteCatalog::propagate` of the satellite since it was
+    /// added or since `SatelliteCatalog::reset_stats`, but not `propagate_grid`,
+    /// which can propagate a satellite from several threads at once and only
+    /// counts towards `perturb::thread_stats`. The lanes are timed per block of
+    /// `CATALOG_LANES` satellites, split evenly between them, on top of the time
+    /// each deep-space satellite takes before the Kepler solve.
+    ///
+    /// @param i Index of the satellite in the catalog
+    /// @param out Returned statistics, left as-is if they aren't collected
+    /// @return If statistics are collected
+    bool stats(std::size_t i, PropagationStats &out) const;
+
+    /// Reset the propagation statistics of every satellite to zero
+    void reset_stats();
+
+    /// Propagate every satellite in the catalog to the same time point.
+    ///
+    /// Results are written in catalog order, so `out_sv[i]` corresponds to the
+    /// satellite at index `i`. Just like `propagate_batch`, failed satellites
+    /// don't stop the rest from being propagated. The contents of a state
+    /// vector are unspecified if its satellite returned an error.
+    ///
+    /// @param jd Time point in UTC or UT1 to propagate all satellites to
+    /// @param out_sv Array of `size()` returned state vectors in the TEME frame
+    /// @param out_err Array of `size()` returned errors, or `nullptr` to ignore them
+    /// @param precision Precision of the near-Earth kernel (default double)
+    /// @return Number of satellites where propagation returned an error
+    std::size_t propagate(
+        JulianDate jd, StateVector *out_sv, Sgp4Error *out_err,
+        CatalogPrecision precision = CatalogPrecision::DOUBLE
+    );
+
+    /// Propagate every satellite in the catalog to the same time point, written
+    /// straight into columns.
+    ///
+    /// Same as the `StateVector` overload, and with bit-identical results, but
+    /// each lane of the kernels is stored straight into the caller's columns.
+    /// The values of a satellite that returned an error are unspecified.
+    ///
+    /// @param jd Time point in UTC or UT1 to propagate all satellites to
+    /// @param out Columns with room for `size()` satellites each, in the TEME frame
+    /// @param out_err Array of `size()` returned errors, or `nullptr` to ignore them
+    /// @param precision Precision of the near-Earth kernel (default double)
+    /// @return Number of satellites where propagation returned an error
+    std::size_t propagate(
+        JulianDate jd, const StateColumns &out, Sgp4Error *out_err,
+        CatalogPrecision precision = CatalogPrecision::DOUBLE
+    );
+
+    /// Propagate a range of satellites in the catalog to a grid of time points.
+    ///
+    /// Unlike `propagate`, this doesn't modify the catalog, so it's safe to call
+    /// concurrently from multiple threads, as long as the output ranges don't
+    /// overlap. Outputs are laid out time-major, so the result for time `k` and
+    /// satellite `i` goes in `out_sv[k * size() + i]`. Only the entries for
+    /// satellites in `[first, last)` are written.
+    ///
+    /// @param first Index of the first satellite to propagate
+    /// @param last One past the index of the last satellite to propagate
+    /// @param times Array of `n_times` time points in UTC or UT1
+    /// @param n_times Number of time points
+    /// @param out_sv Array of `n_times * size()` returned state vectors
+    /// @param out_err Array of `n_times * size()` returned errors, or `nullptr`
+    /// @param precision Precision of the near-Earth kernel (default double)
+    /// @return Number of propagations in the range that returned an error
+    std::size_t propagate_grid(
+        std::size_t first, std::size_t last, const JulianDate *times,
+        std::size_t n_times, StateVector *out_sv, Sgp4Error *out_err,
+        CatalogPrecision precision = CatalogPrecision::DOUBLE
+    ) const;
+
+private:
+    /// Near-Earth SGP4 coefficients stored as one column per field.
+    ///
+    /// Each column is padded to a multiple of `CATALOG_LANES` by repeating the last
+    /// satellite, so the kernel never needs a partial block.
+    struct NearEarthColumns {
+        std::vector<double> jdsatepoch, jdsatepochF;
+        std::vector<double> mo, mdot, argpo, argpdot, nodeo, nodedot, nodecf;
+        std::vector<double> bstar, cc1, cc4, cc5, t2cof, t3cof, t4cof, t5cof;
+        std::vector<double> d2, d3, d4, omgcof, xmcof, eta, delmo, sinmao;
+        std::vector<double> no_unkozai, ecco, inclo, aycof, xlcof;
+        std::vector<double> con41, x1mth2, x7thm1;
+        // Only filled in if the satellites don't all share a gravity model
+        std::vector<double> xke, j2, radiusearthkm;
+    };
+
+    /// Where the kernels write their results, either state vectors or columns
+    struct StateSink;
+
+    /// Pointer to one of the `propagate_near_earth_block` instantiations
+    using NearEarthKernel = std::size_t (SatelliteCatalog::*)(
+        std::size_t, std::size_t, std::size_t, JulianDate, const StateSink &,
+        Sgp4Error *, PropagationStats *
+    ) const;
+
+    /// Propagate every satellite to the same time point, for both overloads
+    std::size_t propagate_into(
+        JulianDate jd, const StateSink &out, Sgp4Error *out_err,
+        CatalogPrecision precision
+    );
+
+    /// Pick the near-Earth kernel for a precision and the catalog's gravity model
+    NearEarthKernel near_earth_kernel(CatalogPrecision precision) const;
+
+    /// Propagate the `CATALOG_LANES` near-Earth columns starting at column `first`.
+    ///
+    /// Only the results of columns in `[col_begin, col_end)` are written out.
+    /// `Real` is `double`, or `float` for `CatalogPrecision::MIXED`, and `Grav`
+    /// supplies the gravity constants, either from the columns or as immediates.
+    /// If statistics are collected and `out_stats` isn't `nullptr`, each
+    /// satellite's are added to `out_stats` at its catalog index too.
+    template <typename Real, typename Grav>
+    std::size_t propagate_near_earth_block(
+        std::size_t first, std::size_t col_begin, std::size_t col_end, JulianDate jd,
+        const StateSink &out, Sgp4Error *out_err, PropagationStats *out_stats
+    ) const;
+
+    /// Propagate the `n` deep-space satellites starting at `first` in `deep_idx_`.
+    ///
+    /// At most `CATALOG_LANES` satellites, whose states are `states[0, n)`. The
+    /// part before the Kepler solve runs one satellite at a time, since the
+    /// lunar-solar terms and the resonance integrator branch too much to batch,
+    /// then the rest runs in lanes. Statistics are added like the near-Earth kernel.
+    std::size_t propagate_deep_block(
+        std::size_t first, std::size_t n, JulianDate jd, sgp4::elsetrec_state *states,
+        const StateSink &out, Sgp4Error *out_err, PropagationStats *out_stats
+    ) const;
+
+    std::vector<Satellite> sats_;
+    std::vector<std::size_t> near_idx_;  ///< Catalog index of each near-Earth column
+    std::vector<std::size_t> deep_idx_;  ///< Catalog index of each deep-space satellite
+    // Hot data of each deep-space satellite, with `sats_` as the cold table
+    std::vector<sgp4::elsetrec_compact> deep_recs_;
+    std::vector<sgp4::elsetrec_state> deep_states_;  ///< Kept between `propagate` calls
+    NearEarthColumns near_;
+    bool near_grav_uniform_ = false;  ///< If the near-Earth satellites share a model
+    GravModel near_grav_model_ = GravModel::WGS72;
+    /// Statistics of each satellite, only if `PERTURB_ENABLE_STATS` is defined
+    std::vector<PropagationStats> stats_;
+};
+
+/// Initialize many satellites from pre-parsed TLEs across multiple threads.
+///
+/// Each satellite is exactly the same as `Satellite(tles[i], grav_model)`,
+/// including the ones that fail to initialize, so that `out_sats` lines up with
+/// `tles`. The TLEs are handed out to the threads in small blocks as they
+/// finish, since deep-space satellites take several times longer to initialize
+/// than near-Earth ones. Failed satellites don't stop the rest from being
+/// initialized.
+///
+/// @param tles Array of `n_tles` pre-parsed TLEs
+/// @param n_tles Number of TLEs
+/// @param out_sats Initialized satellites are appended to this, one per TLE
+/// @param out_err Array of `n_tles` returned init errors, or `nullptr` to ignore them
+/// @param grav_model Gravity constants to use (default `GravModel::WGS72`)
+/// @param n_threads Number of threads, or 0 to use the hardware concurrency.
+///                  Always 1 if `PERTURB_DISABLE_THREADS` is defined.
+/// @return Number of satellites that returned an error when initialized
+std::size_t init_satellites(
+    const TwoLineElement *tles, std::size_t n_tles, std::vector<Satellite> &out_sats,
+    Sgp4Error *out_err, GravModel grav_model = GravModel::WGS72,
+    std::size_t n_threads = 0
+);
+
+}  // namespace perturb
+
+#endif  // PERTURB_CATALOG_HPP
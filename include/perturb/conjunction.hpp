@@ -0,0 +1,96 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for screening a catalog for close approaches between satellites
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_CONJUNCTION_HPP
+#define PERTURB_CONJUNCTION_HPP
+
+#include "perturb/catalog.hpp"
+#include "perturb/perturb.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace perturb {
+
+/// Precision of the closest approach times of `perturb::screen_conjunctions` in [s]
+constexpr double TCA_TIME_TOLERANCE = 1e-3;
+
+/// Allowance for how far the radius of an orbit strays from the perigee and
+/// apogee of its mean elements at epoch in [km], from short-period terms and drag
+constexpr double SHELL_MARGIN = 50.0;
+
+/// A close approach between two satellites of a catalog
+struct Conjunction {
+    std::size_t sat_a;      ///< Catalog index of the first satellite, less than `sat_b`
+    std::size_t sat_b;      ///< Catalog index of the second satellite
+    JulianDate tca;         ///< Time of closest approach
+    double miss_distance;   ///< Distance between the satellites at `tca` in [km]
+    double relative_speed;  ///< Speed of one satellite relative to the other in [km/s]
+};
+
+/// Find every close approach between any two satellites of a catalog.
+///
+/// Unlike the rest of the library, this uses dynamic memory. Instead of
+/// checking all pairs, the whole catalog is propagated to evenly spaced time
+/// steps, and a pair is only looked at when it can get within the threshold
+/// before the neighbouring steps:
+///   1. At each step, the positions are bucketed into a spatial hash, with
+///      cells as large as the threshold plus the distance the fastest pair
+///      could close in a step. Only satellites in the same or adjacent cells
+///      are paired up, so each step costs time linear in the catalog size.
+///   2. Pairs whose perigee to apogee shells, from `sgp4::elsetrec::altp` and
+///      `alta`, are further apart than the threshold plus `SHELL_MARGIN` are
+///      dropped.
+///   3. The relative motion of the rest is taken to be a straight line over
+///      the half step on either side, which is accurate to well under a
+///      kilometer since both satellites feel nearly the same gravity. If its
+///      closest point is within the threshold (plus that error), the pair is
+///      a candidate.
+///   4. Each candidate is refined by propagating both satellites to the root
+///      of their range rate, to within `perturb::TCA_TIME_TOLERANCE`.
+///
+/// Time steps are handed out across multiple threads. Conjunctions are sorted
+/// by time of closest approach, and an encounter that shows up at consecutive
+/// steps is only reported once. An approach that's still closing at the start
+/// or end of the window is reported at that edge.
+///
+/// @pre `step_secs` must be positive. Steps longer than about 645 s, a little
+///      over a tenth of the shortest orbit period, are shortened to that, since
+///      past it the relative motion over a step strays too far from a straight
+///      line to bound.
+///
+/// @param catalog Satellites to screen
+/// @param start Start of the screening window in UTC
+/// @param end End of the screening window in UTC
+/// @param threshold Miss distance in [km] at or below which to report a pair
+/// @param out Conjunctions found are appended to this
+/// @param step_secs Time between steps in [s]. Doesn't change which
+///                  conjunctions are found, only the balance between
+///                  propagating more steps and pairing up more satellites.
+/// @param n_threads Number of threads, or 0 to use the hardware concurrency.
+///                  Always 1 if `PERTURB_DISABLE_THREADS` is defined.
+/// @return Number of propagations that returned an error. A satellite is
+///         skipped at any step where it fails to propagate.
+std::size_t screen_conjunctions(
+    const SatelliteCatalog &catalog, JulianDate start, JulianDate end,
+    double threshold, std::vector<Conjunction> &out, double step_secs = 30.0,
+    std::size_t n_threads = 0
+);
+
+}  // namespace perturb
+
+#endif  // PERTURB_CONJUNCTION_HPP
@@ -0,0 +1,130 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for interpolating ephemerides fitted to SGP4
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_EPHEMERIS_HPP
+#define PERTURB_EPHEMERIS_HPP
+
+#include "perturb/perturb.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace perturb {
+
+/// Degree of the Chebyshev series of each segment of an `Ephemeris`
+constexpr std::size_t EPHEMERIS_DEGREE = 8;
+
+/// Shortest segment `Ephemeris` tries before giving up on the error bound, in [s]
+constexpr double EPHEMERIS_MIN_SEGMENT = 1.0;
+
+/// A satellite's trajectory over a time window, fitted with Chebyshev series
+/// for cheap queries at any time inside it.
+///
+/// Unlike the rest of the library, this type uses dynamic memory. The window
+/// is split into segments, and in each one SGP4 is sampled at the Chebyshev
+/// extrema (which include both ends, so neighbouring segments share a sample).
+/// Both the position and the velocity are fitted with a series of degree
+/// `perturb::EPHEMERIS_DEGREE` through those samples. A query is then a binary
+/// search for the segment and a few dozen multiply-adds, instead of a full
+/// SGP4 evaluation.
+///
+/// The velocity gets its own series, instead of being the derivative of the
+/// position, since SGP4's velocity isn't exactly the derivative of its
+/// position (by up to a few m/s for eccentric orbits), and a drop-in should
+/// match SGP4 on both.
+///
+/// The segments are sized adaptively. Each one is checked against SGP4
+/// halfway between every pair of samples, and is shortened until all of them
+/// are within half the error bound. Checking all the way through also catches
+/// the small kinks SGP4 has in places, like the steps of the deep-space
+/// resonance integrator. The next segment then grows according to how much
+/// room was left, since the error scales with the ninth power of the length.
+/// So the segments are long around apogee and short around perigee.
+///
+/// It can be used in place of a `Satellite`, since the `propagate` overloads
+/// take the same arguments. Times outside the fitted window fall back to
+/// propagating the satellite directly, so they get the exact SGP4 result.
+class Ephemeris {
+public:
+    /// Fit an ephemeris to a satellite over a time window.
+    ///
+    /// If propagation returns an error partway, the fit stops at the last node
+    /// before it, and the error is kept in `Ephemeris::last_error`. The fit also
+    /// stops early if even a segment of `perturb::EPHEMERIS_MIN_SEGMENT` can't
+    /// meet the error bound, which only happens where SGP4 itself breaks down,
+    /// like just before a decay. Either way, later times are left to `propagate`
+    /// to fall back on the satellite.
+    ///
+    /// @param sat Initialized satellite, copied into the ephemeris
+    /// @param start Start of the window in UTC or UT1
+    /// @param end End of the window in UTC or UT1
+    /// @param max_error Bound on the position error inside the window in [km]
+    ///                  (default 1 m)
+    Ephemeris(
+        const Satellite &sat, JulianDate start, JulianDate end, double max_error = 1e-3
+    );
+
+    /// Satellite the ephemeris was fitted to
+    const Satellite &satellite() const;
+
+    /// Error that cut the fit short, or `Sgp4Error::NONE`
+    Sgp4Error last_error() const;
+
+    /// Start of the fitted window
+    JulianDate start() const;
+
+    /// End of the fitted window, earlier than requested if the fit was cut short
+    JulianDate end() const;
+
+    /// Number of fitted segments
+    std::size_t size() const;
+
+    /// Look up the state vector based on time around the satellite's epoch.
+    ///
+    /// @param mins_from_epoch Offset number of minutes around the epoch
+    /// @param sv Returned state vector in the TEME frame
+    /// @return Issues during propagation, should usually be `Sgp4Error::NONE`
+    Sgp4Error propagate_from_epoch(double mins_from_epoch, StateVector &sv) const;
+
+    /// Look up the state vector at a specific time point.
+    ///
+    /// Inside the window, the position is within `max_error` of direct
+    /// propagation, and the velocity is within `max_error` times the mean
+    /// motion. Any number of threads can query the same ephemeris at once.
+    ///
+    /// @param jd Time point in UTC or UT1
+    /// @param sv Returned state vector in the TEME frame
+    /// @return Issues during propagation, should usually be `Sgp4Error::NONE`
+    Sgp4Error propagate(JulianDate jd, StateVector &sv) const;
+
+private:
+    /// Chebyshev coefficients of each axis, over the segment scaled to [-1, 1]
+    struct Segment {
+        double position[EPHEMERIS_DEGREE + 1][3];
+        double velocity[EPHEMERIS_DEGREE + 1][3];
+    };
+
+    Satellite sat_;
+    Sgp4Error last_error_;
+    JulianDate start_;
+    std::vector<double> nodes_;  ///< Time of each node in [s] from `start_`
+    std::vector<Segment> segments_;
+};
+
+}  // namespace perturb
+
+#endif  // PERTURB_EPHEMERIS_HPP
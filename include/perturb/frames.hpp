@@ -0,0 +1,305 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for converting TEME state vectors to Earth-fixed and geodetic frames
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_FRAMES_HPP
+#define PERTURB_FRAMES_HPP
+
+#include "perturb/perturb.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace perturb {
+
+/// Rotation rate of the Earth in [rad/s], ignoring variations in length of day
+constexpr double EARTH_ROTATION_RATE = 7.292115146706979e-5;
+
+/// Equatorial radius of the WGS84 ellipsoid in [km]
+constexpr double WGS84_RADIUS = 6378.137;
+
+/// Flattening of the WGS84 ellipsoid
+constexpr double WGS84_FLATTENING = 1.0 / 298.257223563;
+
+/// Steps `EarthRotationCache` advances before recomputing GMST from scratch
+constexpr std::size_t EARTH_ROTATION_RESYNC_STEPS = 1024;
+
+/// Earth orientation parameters at a point in time.
+///
+/// These are the small corrections published daily by the IERS, and can be
+/// looked up from an `EopTable`. All zeros (the default) means UT1 is taken to
+/// be UTC and the pole isn't moved, which is what the library assumes
+/// everywhere else, and is within the accuracy of SGP4 itself.
+struct EarthOrientation {
+    double xp;       ///< Polar motion x in [rad]
+    double yp;       ///< Polar motion y in [rad]
+    double ut1_utc;  ///< Difference UT1 - UTC in [s]
+};
+
+/// Position and velocity in the Earth-fixed ECEF (ITRF) frame.
+///
+/// Generated from a TEME `StateVector` by `perturb::to_ecef`. Without any
+/// polar motion, this is really the pseudo Earth-fixed (PEF) frame, which is
+/// off from ITRF by at most about 15 m on the Earth's surface.
+struct EcefState {
+    /// Time-stamp of the state vector
+    JulianDate epoch;
+    /// Position in the ECEF frame in [km]
+    Vec3 position;
+    /// Velocity relative to the rotating ECEF frame in [km/s]
+    Vec3 velocity;
+};
+
+/// Geodetic coordinates on the WGS84 ellipsoid
+struct Geodetic {
+    double latitude;   ///< Geodetic latitude from -pi/2 to pi/2 in [rad]
+    double longitude;  ///< Longitude east from -pi to pi in [rad]
+    double altitude;   ///< Height above the ellipsoid in [km]
+};
+
+/// The rotation from TEME to ECEF at one point in time.
+///
+/// Computing Greenwich mean sidereal time and the polar motion terms is the
+/// expensive part of converting a state vector, and it only depends on time.
+/// This caches them, so that converting every satellite of a catalog at the
+/// same time point only costs a few multiplies each. The batch overloads of
+/// `perturb::to_ecef` and `perturb::to_geodetic` use this automatically.
+class EarthRotation {
+public:
+    /// Compute the rotation at a time point.
+    ///
+    /// @param jd Time point in UTC
+    /// @param eop Earth orientation parameters at that time, or all zeros
+    explicit EarthRotation(JulianDate jd, const EarthOrientation &eop = {});
+
+    /// Time point the rotation is for, in UTC
+    JulianDate epoch() const;
+
+    /// Greenwich mean sidereal time in [rad], using UT1 if it was given
+    double gmst() const;
+
+    /// Rotate a position from TEME to ECEF.
+    ///
+    /// @param teme Position in the TEME frame
+    /// @return Same position in the ECEF frame
+    Vec3 rotate(const Vec3 &teme) const;
+
+    /// Convert a TEME state vector to ECEF.
+    ///
+    /// The rotation is used as-is, without checking that the state vector has
+    /// the same time-stamp.
+    ///
+    /// @param sv Position and velocity in the TEME frame
+    /// @return Position and velocity in the ECEF frame
+    EcefState to_ecef(const StateVector &sv) const;
+
+private:
+    friend class EarthRotationCache;
+
+    /// Uninitialized, for `EarthRotationCache` to fill in
+    EarthRotation() = default;
+
+    JulianDate epoch_;
+    double gmst_;
+    double cos_gmst_, sin_gmst_;
+    // Polar motion, from PEF to ECEF
+    double cos_xp_, sin_xp_, cos_yp_, sin_yp_;
+};
+
+/// A table of daily Earth orientation parameters.
+///
+/// Unlike the rest of the library, this type uses dynamic memory. Values
+/// between two rows are linearly interpolated, and times outside the table
+/// use the closest row. Leap seconds in UT1 - UTC are handled, so that the
+/// interpolated value doesn't sweep through the jump over a whole day.
+class EopTable {
+public:
+    /// Construct an empty table, where every lookup returns all zeros
+    EopTable();
+
+#ifndef PERTURB_DISABLE_IO
+    /// Add every row of an IERS `finals.all` or `finals2000A.all` file.
+    ///
+    /// Only the IERS Bulletin A polar motion and UT1 - UTC columns are used.
+    /// Rows without them (like far-future rows in the daily files) are
+    /// skipped. Not available if `PERTURB_DISABLE_IO` is defined.
+    ///
+    /// @param path Path to the file
+    /// @return If the file could be read and had at least one usable row
+    bool load(const char *path);
+#endif  // PERTURB_DISABLE_IO
+
+    /// Add a row to the table.
+    ///
+    /// @pre Rows must be added in order of increasing `mjd`.
+    ///
+    /// @param mjd Modified Julian date of the row in UTC
+    /// @param eop Earth orientation parameters on that date
+    void add(double mjd, const EarthOrientation &eop);
+
+    /// Number of rows in the table
+    std::size_t size() const;
+
+    /// Look up the Earth orientation parameters at a time point.
+    ///
+    /// @param jd Time point in UTC
+    /// @return Interpolated parameters, or all zeros if the table is empty
+    EarthOrientation at(JulianDate jd) const;
+
+private:
+    std::vector<double> mjd_;
+    std::vector<EarthOrientation> eop_;
+};
+
+/// The `EarthRotation` of the latest time point, for converting many
+/// satellites at one time point after another.
+///
+/// Looking up a time point only computes GMST (and looks up the `EopTable`)
+/// when it differs from the last one, so a whole catalog at one time point
+/// costs a single evaluation. For time points on a uniform grid, like a
+/// catalog propagated at a fixed rate, `begin_steps` and `next_step` skip
+/// evaluating GMST altogether. Each step instead turns the last rotation by
+/// the constant angle the Earth turns in a step, which is two multiplies
+/// and adds, with the drift of UT1 - UTC taken into account. To keep rounding
+/// from building up, GMST is recomputed from scratch every
+/// `perturb::EARTH_ROTATION_RESYNC_STEPS` steps, and whenever the grid moves
+/// into another UTC day, where the daily Earth orientation parameters change
+/// rate. In between, stepping stays within a few 1e-9 rad of computing it from
+/// scratch, which is about how much rounding that has anyway.
+///
+/// Not safe to share between threads, so use one per thread.
+class EarthRotationCache {
+public:
+    /// Construct an empty cache.
+    ///
+    /// @param eop Table to look up Earth orientation parameters, or `nullptr`
+    ///            for all zeros. Must outlive the cache.
+    explicit EarthRotationCache(const EopTable *eop = nullptr);
+
+    /// Rotation at a time point, only recomputed if it's a different time
+    /// point from the last call.
+    ///
+    /// @param jd Time point in UTC
+    /// @return Rotation at `jd`, valid until the cache is next used
+    const EarthRotation &at(JulianDate jd);
+
+    /// Start stepping through a uniform grid of time points.
+    ///
+    /// Time point `k` of the grid is `start + k * (step / 86400)`.
+    ///
+    /// @param start First time point in UTC
+    /// @param step Time between each time point in [s], which may be negative
+    /// @return Rotation at `start`, valid until the cache is next used
+    const EarthRotation &begin_steps(JulianDate start, double step);
+
+    /// Rotation at the next time point of the grid from `begin_steps`.
+    ///
+    /// @pre `begin_steps` must have been called first.
+    ///
+    /// @return Rotation one step after the last, valid until the cache is next used
+    const EarthRotation &next_step();
+
+    /// Number of times GMST was computed from scratch, rather than reused or stepped
+    std::size_t n_evaluations() const;
+
+private:
+    /// Compute the rotation at a time point from scratch
+    void evaluate(JulianDate jd);
+
+    /// Compute the rotation of one step of the grid around a time point
+    void set_step(JulianDate jd);
+
+    const EopTable *eop_;
+    EarthRotation rot_;
+    bool valid_;
+    std::size_t n_evaluations_;
+    // Uniform grid of `begin_steps`, with the rotation of one step
+    JulianDate start_;
+    double step_days_;
+    double cos_step_, sin_step_, gmst_step_;
+    std::size_t n_steps_;
+};
+
+/// Convert a TEME state vector to the Earth-fixed ECEF frame.
+///
+/// Goes through the usual TEME to PEF to ECEF chain from "Revisiting Spacetrack
+/// Report #3": a rotation by GMST, then by the polar motion. For converting
+/// many state vectors at the same time, use the batch overload or an
+/// `EarthRotationCache` instead, which compute the rotation only once.
+///
+/// @param sv Position and velocity in the TEME frame
+/// @param eop Earth orientation parameters at the state vector's time
+/// @return Position and velocity in the ECEF frame
+EcefState to_ecef(const StateVector &sv, const EarthOrientation &eop = {});
+
+/// Convert many TEME state vectors to the Earth-fixed ECEF frame.
+///
+/// The rotation is only recomputed when the time-stamp changes from one state
+/// vector to the next, so the output of `SatelliteCatalog::propagate` (or
+/// `propagate_grid`) costs a single GMST for each time point.
+///
+/// @param sv Array of `n` state vectors in the TEME frame
+/// @param n Number of state vectors
+/// @param out Array of `n` returned state vectors in the ECEF frame
+/// @param eop Table to look up Earth orientation parameters, or `nullptr`
+void to_ecef(
+    const StateVector *sv, std::size_t n, EcefState *out,
+    const EopTable *eop = nullptr
+);
+
+/// Convert an ECEF position to geodetic coordinates on the WGS84 ellipsoid.
+///
+/// Uses the closed-form method from Olson (1996), "Converting Earth-Centered,
+/// Earth-Fixed Coordinates to Geodetic Coordinates", which is a single
+/// corrected step with errors below a micrometer from the surface up to well
+/// past geostationary orbit.
+///
+/// @pre The position must not be within about 40 km of the Earth's center.
+///
+/// @param position Position in the ECEF frame in [km]
+/// @return Geodetic latitude, longitude, and altitude
+Geodetic to_geodetic(const Vec3 &position);
+
+/// Convert a TEME state vector to geodetic coordinates.
+///
+/// @param sv Position and velocity in the TEME frame
+/// @param eop Earth orientation parameters at the state vector's time
+/// @return Geodetic latitude, longitude, and altitude of the position
+Geodetic to_geodetic(const StateVector &sv, const EarthOrientation &eop = {});
+
+/// Convert many TEME state vectors to geodetic coordinates.
+///
+/// Like the batch `perturb::to_ecef`, the rotation is only recomputed when the
+/// time-stamp changes from one state vector to the next.
+///
+/// @param sv Array of `n` state vectors in the TEME frame
+/// @param n Number of state vectors
+/// @param out Array of `n` returned geodetic coordinates
+/// @param eop Table to look up Earth orientation parameters, or `nullptr`
+void to_geodetic(
+    const StateVector *sv, std::size_t n, Geodetic *out,
+    const EopTable *eop = nullptr
+);
+
+/// Convert geodetic coordinates on the WGS84 ellipsoid to an ECEF position.
+///
+/// @param geo Geodetic latitude, longitude, and altitude
+/// @return Position in the ECEF frame in [km]
+Vec3 to_ecef(const Geodetic &geo);
+
+}  // namespace perturb
+
+#endif  // PERTURB_FRAMES_HPP
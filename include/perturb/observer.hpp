@@ -0,0 +1,239 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for looking at satellites from ground stations
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_OBSERVER_HPP
+#define PERTURB_OBSERVER_HPP
+
+#include "perturb/frames.hpp"
+#include "perturb/perturb.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace perturb {
+
+/// Direction and distance to a satellite as seen from a ground station
+struct LookAngles {
+    double azimuth;     ///< Clockwise from north, from 0 to 2pi in [rad]
+    double elevation;   ///< Above the horizon, from -pi/2 to pi/2 in [rad]
+    double range;       ///< Distance to the satellite in [km]
+    double range_rate;  ///< Rate of change of range in [km/s], positive if receding
+};
+
+/// A fixed observer on the surface of the Earth.
+///
+/// The ECEF position and the rotation from ECEF to the topocentric SEZ
+/// (south, east, zenith) frame are computed once on construction, so looking
+/// at a satellite only takes a subtraction, a rotation, and the angles.
+class GroundStation {
+public:
+    /// Construct a station at a geodetic location.
+    ///
+    /// @param location Geodetic coordinates on the WGS84 ellipsoid
+    /// @param min_elevation Elevation mask in [rad], below which satellites
+    ///                      aren't considered visible (default 0, the horizon)
+    explicit GroundStation(const Geodetic &location, double min_elevation = 0.0);
+
+    /// Geodetic coordinates of the station
+    const Geodetic &location() const;
+
+    /// Position of the station in the ECEF frame in [km]
+    const Vec3 &position() const;
+
+    /// Elevation mask of the station in [rad]
+    double min_elevation() const;
+
+    /// Unit vector pointing straight up from the station in the ECEF frame
+    const Vec3 &zenith() const;
+
+    /// Rotate an ECEF vector into the topocentric SEZ frame of the station.
+    ///
+    /// @param ecef Vector in the ECEF frame
+    /// @return Same vector as south, east, and zenith components
+    Vec3 to_sez(const Vec3 &ecef) const;
+
+    /// Look angles to a satellite.
+    ///
+    /// @param sat Position and velocity of the satellite in the ECEF frame
+    /// @return Azimuth, elevation, range, and range rate
+    LookAngles look_at(const EcefState &sat) const;
+
+    /// If a satellite is at or above the elevation mask
+    bool is_visible(const Vec3 &sat_position) const;
+
+private:
+    Geodetic location_;
+    Vec3 position_;
+    double min_elevation_;
+    double sin_min_elevation_;
+    // Rows of the rotation from ECEF to SEZ
+    Vec3 south_, east_, zenith_;
+};
+
+/// A visible satellite and its look angles from a station
+struct Visibility {
+    std::size_t station;    ///< Index of the station in the `StationNetwork`
+    std::size_t satellite;  ///< Index of the satellite in the input state vectors
+    LookAngles look;        ///< Look angles to the satellite from the station
+};
+
+/// Precision of the AOS, TCA, and LOS times found by `perturb::find_passes` in [s]
+constexpr double PASS_TIME_TOLERANCE = 0.01;
+
+/// A pass of a satellite over a ground station.
+///
+/// Passes that are already in progress at the start of the search window, or
+/// still in progress at the end, are clipped to the window.
+struct Pass {
+    JulianDate aos;        ///< Acquisition of signal, rising above the elevation mask
+    JulianDate tca;        ///< Time of closest approach, at the maximum elevation
+    JulianDate los;        ///< Loss of signal, setting below the elevation mask
+    double max_elevation;  ///< Elevation at `tca` in [rad]
+};
+
+/// Find every pass of a satellite over a ground station in a time window.
+///
+/// Instead of propagating at a fixed step, this takes the largest steps that
+/// can't possibly skip over a pass. The speed of the satellite relative to the
+/// station is bounded using the orbit's semi-major axis (from `no_kozai`) and
+/// eccentricity, which bounds how fast the elevation can approach the mask.
+/// Far below the horizon that allows steps of a good part of an orbit, and
+/// the steps only shrink close to the horizon, down to a small fraction of the
+/// orbit period. A maximum of elevation between two such steps (found from a
+/// change in sign of the elevation rate) is checked too, so even short grazing
+/// passes aren't missed. Once a horizon crossing or a maximum is bracketed, its
+/// time is root-found to within `perturb::PASS_TIME_TOLERANCE`.
+///
+/// @param sat Initialized satellite
+/// @param station Ground station, using its elevation mask
+/// @param start Start of the search window in UTC
+/// @param end End of the search window in UTC
+/// @param out Passes found are appended to this, in time order
+/// @param out_n_evals Returns the number of propagations used, or `nullptr`
+/// @return Issues during propagation, should usually be `Sgp4Error::NONE`.
+///         The search stops at the first error it runs into, keeping the passes
+///         before it and clipping a pass in progress to the last time that
+///         propagated.
+Sgp4Error find_passes(
+    const Satellite &sat, const GroundStation &station, JulianDate start,
+    JulianDate end, std::vector<Pass> &out, std::size_t *out_n_evals = nullptr
+);
+
+/// A pass of one satellite over one station of a `StationNetwork`
+struct StationPass {
+    std::size_t station;    ///< Index of the station in the `StationNetwork`
+    std::size_t satellite;  ///< Index of the satellite in the input satellites
+    Pass pass;              ///< Times and maximum elevation of the pass
+};
+
+/// Computes look angles from many ground stations to many satellites at once.
+///
+/// Unlike the rest of the library, this type uses dynamic memory. For each
+/// time slice, the satellites are rotated to ECEF once and stored as one
+/// column per coordinate. Then for each station, a fixed-width pass over the
+/// columns (which the compiler can map onto SIMD registers) checks the
+/// elevation mask of every satellite by comparing the square of its zenith
+/// component against the squared range, scaled by the sine of the mask. Only
+/// the pairs that pass the mask go on to the square root and the angles, so
+/// satellites below the horizon, usually the vast majority, cost only a
+/// handful of multiplies.
+class StationNetwork {
+public:
+    /// Construct an empty network
+    StationNetwork();
+
+    /// Construct a network from a list of stations.
+    ///
+    /// @param stations Stations, kept in the same order
+    explicit StationNetwork(const std::vector<GroundStation> &stations);
+
+    /// Add a station to the end of the network
+    void add(const GroundStation &station);
+
+    /// Number of stations in the network
+    std::size_t size() const;
+
+    /// Access a station by its index in the network
+    const GroundStation &operator[](std::size_t i) const;
+
+    /// Find every visible station and satellite pair at one time point.
+    ///
+    /// The state vectors are typically the output of `SatelliteCatalog::propagate`,
+    /// and are all converted to ECEF with the rotation at the first one's time.
+    /// Results are appended station by station, and in order of satellite
+    /// within each station.
+    ///
+    /// @pre Every state vector must have the same time-stamp.
+    ///
+    /// @param sv Array of `n_sats` state vectors in the TEME frame
+    /// @param n_sats Number of state vectors
+    /// @param sv_err Array of `n_sats` propagation errors, or `nullptr`. Satellites
+    ///               with an error are skipped.
+    /// @param out Visible pairs and their look angles are appended to this
+    /// @param eop Earth orientation parameters at that time, or all zeros
+    /// @return Number of visible pairs appended
+    std::size_t look_angles(
+        const StateVector *sv, std::size_t n_sats, const Sgp4Error *sv_err,
+        std::vector<Visibility> &out, const EarthOrientation &eop = {}
+    );
+
+    /// Find every visible station and satellite pair from ECEF state vectors.
+    ///
+    /// Same as the TEME overload, but without the conversion to ECEF.
+    ///
+    /// @param sats Array of `n_sats` state vectors in the ECEF frame
+    /// @param n_sats Number of state vectors
+    /// @param out Visible pairs and their look angles are appended to this
+    /// @return Number of visible pairs appended
+    std::size_t look_angles(
+        const EcefState *sats, std::size_t n_sats, std::vector<Visibility> &out
+    );
+
+    /// Find every pass of many satellites over every station in a time window.
+    ///
+    /// Runs `perturb::find_passes` for every station and satellite pair, with
+    /// the satellites handed out across multiple threads. Results are grouped
+    /// by satellite, then by station, and each pair's passes are in time order.
+    /// Satellites that return an error keep the passes found before it.
+    ///
+    /// @param sats Array of `n_sats` initialized satellites
+    /// @param n_sats Number of satellites
+    /// @param start Start of the search window in UTC
+    /// @param end End of the search window in UTC
+    /// @param out Passes found are appended to this
+    /// @param n_threads Number of threads, or 0 to use the hardware concurrency.
+    ///                  Always 1 if `PERTURB_DISABLE_THREADS` is defined.
+    /// @return Number of satellites that returned an error for some station
+    std::size_t find_passes(
+        const Satellite *sats, std::size_t n_sats, JulianDate start, JulianDate end,
+        std::vector<StationPass> &out, std::size_t n_threads = 0
+    ) const;
+
+private:
+    /// Run the kernel over the satellite columns that have been filled in
+    std::size_t look_angles_columns(std::vector<Visibility> &out);
+
+    std::vector<GroundStation> stations_;
+    // Satellite columns for the current time slice, reused between calls
+    std::vector<double> x_, y_, z_, vx_, vy_, vz_;
+    std::vector<std::size_t> sat_idx_;
+    std::vector<double> zenith_, range_sq_;
+};
+
+}  // namespace perturb
+
+#endif  // PERTURB_OBSERVER_HPP
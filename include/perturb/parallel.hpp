@@ -0,0 +1,96 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for propagating satellite catalogs across multiple threads
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_PARALLEL_HPP
+#define PERTURB_PARALLEL_HPP
+
+#ifndef PERTURB_DISABLE_THREADS
+
+#include "perturb/catalog.hpp"
+#include "perturb/perturb.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace perturb {
+
+/// Number of catalog satellites per `ParallelPropagator` task
+constexpr std::size_t PARALLEL_TASK_SATS = 8 * CATALOG_LANES;
+
+/// Minimum number of `ParallelPropagator` tasks per thread, to leave room for stealing
+constexpr std::size_t PARALLEL_TASKS_PER_THREAD = 8;
+
+/// A thread pool for propagating a `SatelliteCatalog` over a grid of times.
+///
+/// The work is split into tasks of `PARALLEL_TASK_SATS` satellites, each over the whole
+/// time grid. The grid is only split up too if there aren't enough satellites
+/// to go around, since deep-space satellites have to restart their resonance
+/// integration at the start of every task. Each worker thread starts out with
+/// an even share of the tasks in its own queue, and once that runs dry it
+/// steals tasks from the other end of the other workers' queues. Deep-space
+/// satellites cost several times more than near-Earth ones, so this keeps all
+/// the threads busy even when they're unevenly spread through the catalog.
+///
+/// The catalog isn't modified (see `SatelliteCatalog::propagate_grid`), and
+/// the results are exactly the same as propagating on a single thread.
+///
+/// The threads are created once on construction and sleep between calls.
+/// A single `ParallelPropagator` should only be used from one thread at a time.
+/// Not available if `PERTURB_DISABLE_THREADS` is defined.
+class ParallelPropagator {
+public:
+    /// Start a pool of worker threads.
+    ///
+    /// @param n_threads Number of threads, or 0 to use the hardware concurrency
+    explicit ParallelPropagator(std::size_t n_threads = 0);
+
+    /// Stop and join all the worker threads
+    ~ParallelPropagator();
+
+    ParallelPropagator(const ParallelPropagator &) = delete;
+    ParallelPropagator &operator=(const ParallelPropagator &) = delete;
+
+    /// Number of worker threads in the pool
+    std::size_t thread_count() const;
+
+    /// Propagate every satellite in a catalog to every time in a grid.
+    ///
+    /// Blocks until all the work is done. Outputs are laid out time-major, so
+    /// the result for time `k` and satellite `i` goes in
+    /// `out_sv[k * catalog.size() + i]`.
+    ///
+    /// @param catalog Catalog of satellites to propagate
+    /// @param times Array of `n_times` time points in UTC or UT1
+    /// @param n_times Number of time points
+    /// @param out_sv Array of `n_times * catalog.size()` returned state vectors
+    /// @param out_err Array of `n_times * catalog.size()` returned errors, or `nullptr`
+    /// @return Number of propagations that returned an error
+    std::size_t propagate(
+        const SatelliteCatalog &catalog, const JulianDate *times, std::size_t n_times,
+        StateVector *out_sv, Sgp4Error *out_err
+    );
+
+private:
+    struct Pool;
+    std::unique_ptr<Pool> pool_;
+};
+
+}  // namespace perturb
+
+#endif  // PERTURB_DISABLE_THREADS
+
+#endif  // PERTURB_PARALLEL_HPP
@@ -22,6 +22,7 @@
 #include "perturb/tle.hpp"
 
 #include <array>
+#include <cstddef>
 #ifndef PERTURB_DISABLE_IO
 #  include <string>
 #endif
@@ -72,6 +73,151 @@ enum class GravModel {
     WGS84
 };
 
+/// Gravity constants of a `GravModel`, known at compile time.
+///
+/// These are the exact same values that `perturb::sgp4::getgravconst` copies
+/// into every `perturb::sgp4::elsetrec`, with the same names as those fields.
+/// Code that's specialized on a single model can use them as immediates
+/// instead of loading them from each satellite's record. They're functions
+/// rather than variables so that they never need a definition outside the
+/// header.
+///
+/// @tparam Model Gravity model to get the constants of
+template <GravModel Model>
+struct GravConstants;
+
+/// Gravity constants of `GravModel::WGS72_OLD`
+template <>
+struct GravConstants<GravModel::WGS72_OLD> {
+    /// Gravitational parameter of the Earth in [km^3 / s^2]
+    static constexpr double mus() {
+        return 398600.79964;
+    }
+
+    /// Radius of the Earth in [km]
+    static constexpr double radiusearthkm() {
+        return 6378.135;
+    }
+
+    /// Reciprocal of `tumin`
+    static constexpr double xke() {
+        return 0.0743669161;
+    }
+
+    /// Minutes per canonical time unit
+    static constexpr double tumin() {
+        return 1.0 / xke();
+    }
+
+    /// J2 zonal harmonic
+    static constexpr double j2() {
+        return 0.001082616;
+    }
+
+    /// J3 zonal harmonic
+    static constexpr double j3() {
+        return -0.00000253881;
+    }
+
+    /// J4 zonal harmonic
+    static constexpr double j4() {
+        return -0.00000165597;
+    }
+
+    /// J3 divided by J2
+    static constexpr double j3oj2() {
+        return j3() / j2();
+    }
+};
+
+/// Gravity constants of `GravModel::WGS72`
+template <>
+struct GravConstants<GravModel::WGS72> {
+    /// Gravitational parameter of the Earth in [km^3 / s^2]
+    static constexpr double mus() {
+        return 398600.8;
+    }
+
+    /// Radius of the Earth in [km]
+    static constexpr double radiusearthkm() {
+        return 6378.135;
+    }
+
+    /// Reciprocal of `tumin`
+    static constexpr double xke() {
+        return 0.074366916133173422;
+    }
+
+    /// Minutes per canonical time unit
+    static constexpr double tumin() {
+        return 1.0 / xke();
+    }
+
+    /// J2 zonal harmonic
+    static constexpr double j2() {
+        return 0.001082616;
+    }
+
+    /// J3 zonal harmonic
+    static constexpr double j3() {
+        return -0.00000253881;
+    }
+
+    /// J4 zonal harmonic
+    static constexpr double j4() {
+        return -0.00000165597;
+    }
+
+    /// J3 divided by J2
+    static constexpr double j3oj2() {
+        return j3() / j2();
+    }
+};
+
+/// Gravity constants of `GravModel::WGS84`
+template <>
+struct GravConstants<GravModel::WGS84> {
+    /// Gravitational parameter of the Earth in [km^3 / s^2]
+    static constexpr double mus() {
+        return 398600.5;
+    }
+
+    /// Radius of the Earth in [km]
+    static constexpr double radiusearthkm() {
+        return 6378.137;
+    }
+
+    /// Reciprocal of `tumin`
+    static constexpr double xke() {
+        return 0.074366853168713845;
+    }
+
+    /// Minutes per canonical time unit
+    static constexpr double tumin() {
+        return 1.0 / xke();
+    }
+
+    /// J2 zonal harmonic
+    static constexpr double j2() {
+        return 0.00108262998905;
+    }
+
+    /// J3 zonal harmonic
+    static constexpr double j3() {
+        return -0.00000253215306;
+    }
+
+    /// J4 zonal harmonic
+    static constexpr double j4() {
+        return -0.00000161098761;
+    }
+
+    /// J3 divided by J2
+    static constexpr double j3oj2() {
+        return j3() / j2();
+    }
+};
+
 /// A basic and human readable representation of a point in time.
 ///
 /// The primary purpose of this type is to be constructed manually via
@@ -230,6 +376,8 @@ struct ClassicalOrbitalElements {
     );
 };
 
+class ResonanceCheckpoints;
+
 /// Represents a specific orbital ephemeris for an Earth-centered trajectory.
 ///
 /// This is the primary type in this library. Wraps the internal SGP4 record
@@ -319,7 +467,162 @@ public:
     /// @param posvel Returned state vector in the TEME frame
     /// @return Issues during propagation, should usually be `Sgp4Error::NONE`
     Sgp4Error propagate(JulianDate jd, StateVector &sv);
+
+    /// Propagate the SGP4 model based on time around the epoch, without
+    /// modifying the satellite.
+    ///
+    /// Gives the exact same results as the non-const overload, but doesn't
+    /// update `Satellite::last_error`, so any number of threads can propagate
+    /// the same satellite at once. The one downside is for deep-space resonant
+    /// orbits, where the non-const overload carries on its numerical
+    /// integration from the previous call, while this restarts from epoch.
+    ///
+    /// @param mins_from_epoch Offset number of minutes around the epoch
+    /// @param posvel Returned state vector in the TEME frame
+    /// @return Issues during propagation, should usually be `Sgp4Error::NONE`
+    Sgp4Error propagate_from_epoch(double mins_from_epoch, StateVector &sv) const;
+
+    /// Propagate the SGP4 model to a specific time point, without modifying the
+    /// satellite.
+    ///
+    /// See the const overload of `Satellite::propagate_from_epoch` for details.
+    ///
+    /// @param jd Time point in UTC or UT1
+    /// @param posvel Returned state vector in the TEME frame
+    /// @return Issues during propagation, should usually be `Sgp4Error::NONE`
+    Sgp4Error propagate(JulianDate jd, StateVector &sv) const;
+
+    /// Propagate the SGP4 model to a specific time point, keeping everything
+    /// that changes between calls in a caller-owned `state`.
+    ///
+    /// Reusing the same `state` for consecutive calls lets deep-space resonant
+    /// orbits carry on their numerical integration, just like the non-const
+    /// overload, without modifying the satellite. Start with a value
+    /// initialized state (`sgp4::elsetrec_state state {};`) and only use it
+    /// with this satellite.
+    ///
+    /// @param jd Time point in UTC or UT1
+    /// @param posvel Returned state vector in the TEME frame
+    /// @param state Per-call SGP4 state, also holds the singly averaged elements
+    /// @return Issues during propagation, should usually be `Sgp4Error::NONE`
+    Sgp4Error propagate(
+        JulianDate jd, StateVector &sv, sgp4::elsetrec_state &state
+    ) const;
+
+    /// Propagate the SGP4 model to a series of evenly spaced time points.
+    ///
+    /// Equivalent to calling `Satellite::propagate` at `start + k * step_sec`
+    /// for `k` in `[0, count)`, but much cheaper. The time offsets are worked
+    /// out once up front, and deep-space resonant orbits carry on their
+    /// numerical integration from one step to the next. The satellite isn't
+    /// modified. Since the time offset of each step is calculated slightly
+    /// differently, results may differ from `propagate` by an ulp or so.
+    ///
+    /// Stops at the first step that returns an error, and the state vectors
+    /// from that step onwards are unspecified.
+    ///
+    /// @param start First time point in UTC or UT1
+    /// @param step_sec Time between consecutive points in seconds, may be negative
+    /// @param count Number of time points
+    /// @param out Array of `count` returned state vectors in the TEME frame
+    /// @param n_valid Returned number of steps before any error, or `nullptr`
+    /// @return Error from the first failed step, or `Sgp4Error::NONE`
+    Sgp4Error propagate_range(
+        JulianDate start, double step_sec, std::size_t count, StateVector *out,
+        std::size_t *n_valid = nullptr
+    ) const;
+
+    /// Propagate the SGP4 model to a specific time point, resuming deep-space
+    /// resonance integration from the nearest checkpoint.
+    ///
+    /// Meant for querying deep-space resonant orbits (like GEO or Molniya) at
+    /// times in any order, see `ResonanceCheckpoints`. Gives the exact same
+    /// results as the other overloads of `Satellite::propagate`.
+    ///
+    /// @param jd Time point in UTC or UT1
+    /// @param posvel Returned state vector in the TEME frame
+    /// @param state Per-call SGP4 state, see the overload without checkpoints
+    /// @param checkpoints Checkpoints only ever used with this satellite
+    /// @return Issues during propagation, should usually be `Sgp4Error::NONE`
+    Sgp4Error propagate(
+        JulianDate jd, StateVector &sv, sgp4::elsetrec_state &state,
+        ResonanceCheckpoints &checkpoints
+    ) const;
 };
+
+/// Number of checkpoints `ResonanceCheckpoints` keeps on each side of epoch
+constexpr std::size_t RESONANCE_CHECKPOINTS = 32;
+
+/// Initial number of 720 minute integrator steps between resonance checkpoints
+constexpr std::size_t RESONANCE_CHECKPOINT_STEPS = 8;
+
+/// Snapshots of the deep-space resonance integrator of a single satellite.
+///
+/// For deep-space resonant orbits, SGP4 numerically integrates the resonance
+/// terms from epoch in fixed 720 minute steps. Propagating to a time before
+/// the previous one, or on the other side of epoch, restarts that integration
+/// from epoch, so random-order queries far from epoch get expensive. This
+/// keeps snapshots of the integrator every `RESONANCE_CHECKPOINT_STEPS` steps
+/// on either side of epoch, built lazily as they're needed, so a query only
+/// has to integrate from the closest snapshot before it.
+///
+/// Memory use is fixed at `RESONANCE_CHECKPOINTS` snapshots on each side of
+/// epoch. Once a side is full, every other snapshot is dropped and the spacing
+/// is doubled, so any distance from epoch is still covered. Since integration
+/// always follows the same steps, results are bit-for-bit identical to
+/// integrating straight from epoch.
+class ResonanceCheckpoints {
+public:
+    /// Construct without any checkpoints
+    ResonanceCheckpoints();
+
+    /// Move the integrator in `state` to the closest checkpoint before a time.
+    ///
+    /// Nothing happens if the satellite isn't deep-space resonant, or if
+    /// `state` is already at least as close. Creates any missing checkpoints
+    /// up to the time.
+    ///
+    /// @param sat Satellite that these checkpoints are for
+    /// @param mins_from_epoch Offset number of minutes around the epoch
+    /// @param state Per-call SGP4 state to be passed to `sgp4::sgp4` next
+    void resume(
+        const Satellite &sat, double mins_from_epoch, sgp4::elsetrec_state &state
+    );
+
+    /// Number of checkpoints currently kept on both sides of epoch
+    std::size_t size() const;
+
+private:
+    /// Integrator snapshots on one side of epoch
+    struct Side {
+        std::size_t count;  ///< Number of snapshots kept
+        std::size_t steps;  ///< Integrator steps between snapshots
+        /// Snapshot `i` is at `(i + 1) * steps` integrator steps from epoch
+        double atime[RESONANCE_CHECKPOINTS], xli[RESONANCE_CHECKPOINTS],
+            xni[RESONANCE_CHECKPOINTS];
+    };
+
+    Side forward_, backward_;
+};
+
+/// Propagate many satellites to the same time point in a single call.
+///
+/// Produces the exact same results as calling `Satellite::propagate` on each
+/// satellite, but skips the per-call overhead of constructing intermediate
+/// `JulianDate` values and re-reading the shared time point. Results are
+/// written contiguously, so `out_sv[i]` corresponds to `sats[i]`. Any failed
+/// satellites don't stop the rest of the batch from being propagated.
+///
+/// @param sats Array of `n_sats` initialized satellites
+/// @param n_sats Number of satellites in the batch
+/// @param jd Time point in UTC or UT1 to propagate all satellites to
+/// @param out_sv Array of `n_sats` returned state vectors in the TEME frame
+/// @param out_err Array of `n_sats` returned errors, or `nullptr` to ignore them
+/// @return Number of satellites where propagation returned an error
+std::size_t propagate_batch(
+    Satellite *sats, std::size_t n_sats, JulianDate jd, StateVector *out_sv,
+    Sgp4Error *out_err
+);
 }  // namespace perturb
 
 #endif  // PERTURB_PERTURB_HPP
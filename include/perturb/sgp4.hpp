@@ -133,6 +133,63 @@ typedef struct elsetrec  // NOLINT(modernize-use-using,altera-struct-pack-align)
 
 } elsetrec;
 
+// perturb: everything that `sgp4` changes during propagation, split out from
+// `elsetrec` so that the record itself can be shared read-only. A value
+// initialized (zeroed) state is always valid to start from, but a state should
+// only ever be reused with the same `elsetrec`.
+typedef struct elsetrec_state  // NOLINT(modernize-use-using,altera-struct-pack-align)
+{
+  double t;
+  int    error;
+  // Deep space resonance integrator
+  double atime  , xli    , xni;
+  // Singly averaged mean elements
+  double am     , em     , im     , Om       , om     , mm      , nm;
+  // Recomputed every call for deep space only
+  double aycof  , xlcof  , con41  , x1mth2   , x7thm1;
+  // Near earth terms that never change, cached on the first call
+  int    near_cached;
+  double near_xkepow, near_sinio, near_cosio;
+} elsetrec_state;
+
+// perturb: only the fields of `elsetrec` that `sgp4` reads, laid out in the
+// order it reads them. Leaves out the TLE metadata, the values that are only
+// needed during initialization, and the propagation state, so propagating
+// from it touches about three quarters of the bytes. Filled in from an
+// initialized record with `compact_elsetrec`.
+typedef struct elsetrec_compact  // NOLINT(modernize-use-using,altera-struct-pack-align)
+{
+  double jdsatepoch, jdsatepochF;
+  /* Secular gravity and atmospheric drag */
+  double mo     , mdot   , argpo  , argpdot  , nodeo  , nodedot , nodecf, cc1   ,
+         bstar  , cc4    , t2cof  , omgcof   , eta    , xmcof   , delmo , d2    ,
+         d3     , d4     , cc5    , sinmao   , t3cof  , t4cof   , t5cof ,
+         no_unkozai, ecco, inclo;
+  int    isimp, irez;
+  char   method, operationmode;
+
+  /* Deep Space */
+  double d2201  , d2211  , d3210  , d3222    , d4410  , d4422   , d5220 , d5232 ,
+         d5421  , d5433  , dedt   , del1     , del2   , del3    , didt  , dmdt  ,
+         dnodt  , domdt  , gsto   , xfact    , xlamo  ,
+         e3     , ee2    , peo    , pgho     , pho    , pinco   , plo   , se2   ,
+         se3    , sgh2   , sgh3   , sgh4     , sh2    , sh3     , si2   , si3   ,
+         sl2    , sl3    , sl4    , xgh2     , xgh3   , xgh4    , xh2   , xh3   ,
+         xi2    , xi3    , xl2    , xl3      , xl4    , zmol    , zmos;
+
+  /* Periodics */
+  double j3oj2  , j2     , aycof  , xlcof    , con41  , x1mth2  , x7thm1,
+         radiusearthkm, xke;
+} elsetrec_compact;
+
+// perturb: the mean elements with the long period periodics added, which is
+// everything `sgp4` computes before solving Kepler's equation. Deep space has
+// the lunar-solar periodics added as well.
+typedef struct elsetrec_periodics  // NOLINT(modernize-use-using,altera-struct-pack-align)
+{
+  double am     , nm     , axnl   , aynl     , xl     , xincp   , nodep , sinip ,
+         cosip;
+} elsetrec_periodics;
 
 // namespace SGP4Funcs
 // {
@@ -155,6 +212,35 @@ typedef struct elsetrec  // NOLINT(modernize-use-using,altera-struct-pack-align)
         double r[3], double v[3]
         );
 
+    // perturb: same as above, but doesn't modify `satrec`
+    bool sgp4
+        (
+        const elsetrec& satrec, elsetrec_state& state, double tsince,
+        double r[3], double v[3]
+        );
+
+    // perturb: same as above, but from the compact record
+    bool sgp4
+        (
+        const elsetrec_compact& satrec, elsetrec_state& state, double tsince,
+        double r[3], double v[3]
+        );
+
+    // perturb: only the part of `sgp4` before the Kepler solve, for batched
+    // solvers. Updates `state` the same way, but `state.con41`, `state.x1mth2`,
+    // and `state.x7thm1` are left to the caller. Not counted by the stats.
+    bool sgp4_long_period
+        (
+        const elsetrec_compact& satrec, elsetrec_state& state, double tsince,
+        elsetrec_periodics& out
+        );
+
+    // perturb: copy the fields `sgp4` reads into a compact record
+    void compact_elsetrec
+        (
+        const elsetrec& satrec, elsetrec_compact& out
+        );
+
     void getgravconst
         (
         gravconsttype whichconst,
@@ -0,0 +1,127 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for saving and memory-mapping snapshots of initialized satellites
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_SNAPSHOT_HPP
+#define PERTURB_SNAPSHOT_HPP
+
+#ifndef PERTURB_DISABLE_IO
+
+#include "perturb/perturb.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace perturb {
+
+class MappedFile;
+
+/// Version of the snapshot format, bumped whenever the layout of the file or
+/// the meaning of the initialized SGP4 records changes
+constexpr std::uint32_t SNAPSHOT_FORMAT_VERSION = 1;
+
+/// Possible errors when writing or opening a `Snapshot`.
+///
+/// Errors when opening are checked in definition order, so for example a
+/// `CHECKSUM_MISMATCH` means that the header itself was fine. The one
+/// exception is a file too short to hold a whole header, which is `TRUNCATED`.
+enum class SnapshotError {
+    NONE,                 ///< If no issues
+    CANNOT_OPEN,          ///< If the file couldn't be opened, read, or written
+    BAD_MAGIC,            ///< If the file isn't a perturb snapshot at all
+    ENDIAN_MISMATCH,      ///< If the file was written on a machine of other endianness
+    VERSION_MISMATCH,     ///< If the format version or record layout doesn't match
+    GRAV_MODEL_MISMATCH,  ///< If the satellites use other gravity constants
+    TRUNCATED,            ///< If the file is shorter than its header says
+    CHECKSUM_MISMATCH,    ///< If the records don't match the checksum
+};
+
+/// Write initialized satellites to a binary snapshot file.
+///
+/// The file is a 64-byte header followed by the raw `sgp4::elsetrec` of
+/// every satellite. The header holds a magic string, an endianness tag, the
+/// format version, the size of a record, the gravity model, the number of
+/// records, and a 64-bit FNV-1a checksum of the records. It's only meant to be
+/// read back by the same version of perturb on the same kind of machine.
+///
+/// @param path Path of the file to write, which is overwritten
+/// @param sats Array of `n_sats` initialized satellites
+/// @param n_sats Number of satellites
+/// @param grav_model Gravity model the satellites were initialized with
+/// @return `GRAV_MODEL_MISMATCH` if any satellite wasn't initialized with
+///         `grav_model`, `CANNOT_OPEN` if writing failed, or otherwise `NONE`
+SnapshotError write_snapshot(
+    const char *path, const Satellite *sats, std::size_t n_sats,
+    GravModel grav_model = GravModel::WGS72
+);
+
+/// A read-only view of satellites in a memory-mapped snapshot file.
+///
+/// Opening a snapshot only checks its header and checksum, without parsing
+/// or initializing anything, and the satellites are used straight from the
+/// mapped file. They're only accessible as `const`, so use the `const`
+/// overloads of `Satellite::propagate` (or `SatelliteCatalog` if you copy them).
+///
+/// Not available if `PERTURB_DISABLE_IO` is defined.
+class Snapshot {
+public:
+    /// Construct an empty snapshot, to `open` later
+    Snapshot();
+
+    /// Unmap the file, if any
+    ~Snapshot();
+
+    Snapshot(const Snapshot &) = delete;
+    Snapshot &operator=(const Snapshot &) = delete;
+
+    /// Map a snapshot file and check that it's usable.
+    ///
+    /// Any previously opened file is closed first, and the snapshot is left
+    /// empty if there's an error.
+    ///
+    /// @post See the `perturb::SnapshotError` docs for the order errors are checked.
+    ///
+    /// @param path Path of the snapshot file
+    /// @param grav_model Gravity model the satellites are expected to use
+    /// @param verify_checksum Whether to check the records against the checksum,
+    ///                        which has to read through the whole file
+    /// @return Issues with the file, should usually be `SnapshotError::NONE`
+    SnapshotError open(
+        const char *path, GravModel grav_model = GravModel::WGS72,
+        bool verify_checksum = true
+    );
+
+    /// Number of satellites in the snapshot
+    std::size_t size() const;
+
+    /// Array of `size()` satellites in the mapped file
+    const Satellite *satellites() const;
+
+    /// Access a satellite by its index in the snapshot
+    const Satellite &operator[](std::size_t i) const;
+
+private:
+    std::unique_ptr<MappedFile> file_;
+    const Satellite *sats_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace perturb
+
+#endif  // PERTURB_DISABLE_IO
+
+#endif  // PERTURB_SNAPSHOT_HPP
@@ -0,0 +1,76 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for counters of what SGP4 initialization and propagation spend time on
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_STATS_HPP
+#define PERTURB_STATS_HPP
+
+#include "perturb/perturb.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace perturb {
+
+/// If propagation statistics are collected, set by the `PERTURB_ENABLE_STATS` flag
+#ifdef PERTURB_ENABLE_STATS
+constexpr bool STATS_ENABLED = true;
+#else
+constexpr bool STATS_ENABLED = false;
+#endif
+
+/// Number of `perturb::Sgp4Error` codes, which index `PropagationStats::errors`
+constexpr std::size_t N_SGP4_ERRORS = static_cast<std::size_t>(Sgp4Error::UNKNOWN) + 1;
+
+/// Counters of the events that decide how long SGP4 takes.
+///
+/// Only collected if the `PERTURB_ENABLE_STATS` preprocessor flag is defined,
+/// otherwise the hooks compile away entirely and the counters stay at zero.
+/// Every call of `perturb::sgp4::sgp4init` and `perturb::sgp4::sgp4` is
+/// counted, no matter which part of the library made it, along with the lanes
+/// of `SatelliteCatalog`. The propagation to epoch that `sgp4init` runs to
+/// check the elements counts as a propagation too.
+struct PropagationStats {
+    std::uint64_t n_inits = 0;            ///< Calls of `sgp4init`
+    std::uint64_t init_nanos = 0;         ///< Time spent in `sgp4init` in [ns]
+    std::uint64_t n_propagations = 0;     ///< Calls of `sgp4`, or catalog lanes
+    std::uint64_t propagate_nanos = 0;    ///< Time spent propagating in [ns]
+    std::uint64_t dspace_steps = 0;       ///< 720 minute resonance integrator steps
+    std::uint64_t kepler_iterations = 0;  ///< Iterations of the Kepler solver
+    std::uint64_t kepler_capped = 0;      ///< Kepler solves stopped by the cap of 10
+    std::uint64_t lyddane = 0;            ///< Periodics with the Lyddane modification
+    std::uint64_t errors[N_SGP4_ERRORS] = {};  ///< Propagations by returned error
+
+    /// Add the counters of another set of statistics to this one
+    PropagationStats &operator+=(const PropagationStats &other);
+};
+
+/// Counters of everything the calling thread has initialized and propagated.
+///
+/// Each thread has its own counters, so collecting them needs no
+/// synchronization. Threads spawned by the library, like those of
+/// `ParallelPropagator`, count towards their own counters. Always all zeros
+/// if `PERTURB_ENABLE_STATS` isn't defined.
+///
+/// @return Copy of the calling thread's counters since the last reset
+PropagationStats thread_stats();
+
+/// Reset the calling thread's counters to zero
+void reset_thread_stats();
+
+}  // namespace perturb
+
+#endif  // PERTURB_STATS_HPP
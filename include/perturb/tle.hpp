@@ -58,10 +58,10 @@ enum class TLEParseError {
 /// `Satellite::from_tle` methods.
 ///
 /// The primary purpose of this type is when the `PERTURB_DISABLE_IO` flag is
-/// set, as then there's no way to construct a `Satellite` from a TLE. In such
-/// a case where all I/O and string processing is removed, this type still
-/// allows you to construct and initialize a `Satellite` manually. However, you
-/// must handle your own method of creating the `TwoLineElement`s.
+/// set, as then there's no `Satellite::from_tle`. In such a case where all I/O
+/// and string processing is removed, this type still allows you to construct
+/// and initialize a `Satellite` manually, either from the allocation-free
+/// `TwoLineElement::parse` or from values you've filled in yourself.
 struct TwoLineElement {
     // clang-format off
     // Line 1
@@ -90,7 +90,6 @@ struct TwoLineElement {
     unsigned char line_2_checksum;      ///< Line 2 check-sum
     // clang-format on
 
-#ifndef PERTURB_DISABLE_IO
     /// Parse a TLE record string.
     ///
     /// You *probably* don't need this method. As I explain in the `TwoLineElement`
@@ -102,14 +101,35 @@ struct TwoLineElement {
     /// support every case that Vallado's impl does, so there may be the
     /// occasional false error.
     ///
+    /// Every field is read straight from its fixed columns in the lines, without
+    /// any copying, allocation, or `sscanf`, so this is available even if
+    /// `PERTURB_DISABLE_IO` is defined. Only the first `perturb::TLE_LINE_LEN`
+    /// characters of each line are read, and the lines don't need to be
+    /// null-terminated, so they can point straight into a larger buffer.
+    ///
     /// @post See the `perturb::TLEParseError` docs for the guaranteed error ordering.
     ///
-    /// @param line_1 First line of TLE as C-string of length `perturb::TLE_LINE_LEN`
-    /// @param line_2 Second line of TLE as C-string of length `perturb::TLE_LINE_LEN`
+    /// @param line_1 First line of TLE
+    /// @param len_1 Length of `line_1`, which must be at least `perturb::TLE_LINE_LEN`
+    /// @param line_2 Second line of TLE
+    /// @param len_2 Length of `line_2`, which must be at least `perturb::TLE_LINE_LEN`
     /// @return Issues with parsing, should usually be `TLEParseError::NONE`.
     ///         The parsed values are written into the `TwoLineElement` instance.
+    TLEParseError parse(
+        const char *line_1, std::size_t len_1, const char *line_2, std::size_t len_2
+    );
+
+    /// Wrapper for `TwoLineElement::parse` with lines of length `perturb::TLE_LINE_LEN`.
+    ///
+    /// Lines shorter than that are `TLEParseError::INVALID_FORMAT`.
+    ///
+    /// @pre Each line must be null-terminated, or at least `perturb::TLE_LINE_LEN`
+    ///      characters long.
+    ///
+    /// @param line_1 First line of TLE as C-string of length `perturb::TLE_LINE_LEN`
+    /// @param line_2 Second line of TLE as C-string of length `perturb::TLE_LINE_LEN`
+    /// @return Issues with parsing, should usually be `TLEParseError::NONE`
     TLEParseError parse(const char *line_1, const char *line_2);
-#endif  // PERTURB_DISABLE_IO
 
 #ifndef PERTURB_DISABLE_IO
     /// Wrapper for `TwoLineElement::parse` that accepts C++ style strings.
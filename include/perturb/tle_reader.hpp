@@ -0,0 +1,126 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+//! @file
+//! Header for loading whole files of TLEs at once
+//! @author Gunvir Ranu
+//! @version 1.0.0
+//! @copyright Gunvir Ranu, MIT License
+
+#ifndef PERTURB_TLE_READER_HPP
+#define PERTURB_TLE_READER_HPP
+
+#ifndef PERTURB_DISABLE_IO
+
+#include "perturb/perturb.hpp"
+#include "perturb/tle.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace perturb {
+
+class MappedFile;
+
+/// Value of `TleReadResult::sat_index` for records that weren't loaded
+constexpr std::size_t TLE_NOT_LOADED = static_cast<std::size_t>(-1);
+
+/// Outcome of loading one TLE record with `TleReader::read`
+struct TleReadResult {
+    std::size_t line_number;    ///< Line number of the first TLE line, starting at 1
+    std::string name;           ///< Name line of a 3-line TLE, or empty if none
+    TLEParseError parse_error;  ///< Error from `TwoLineElement::parse`
+    Sgp4Error init_error;       ///< Error from SGP4 init, `INVALID_TLE` if not parsed
+    std::size_t sat_index;      ///< Index in the loaded satellites, or `TLE_NOT_LOADED`
+};
+
+/// Reads all the TLE records out of a file or buffer in one go.
+///
+/// The file is memory-mapped (or read in one go on platforms without `mmap`),
+/// and the lines are found without copying any of them. Both the 2-line and
+/// 3-line formats are supported, even mixed in the same file. A name line
+/// is any line that comes right before a TLE's first line, with the `0 `
+/// prefix used by Space-Track removed if it's there. Empty lines and lines
+/// starting with `#` are skipped. Anything past the first `perturb::TLE_LINE_LEN`
+/// characters of a TLE line is ignored, like the extra columns in `SGP4-VER.TLE`.
+///
+/// Unlike the rest of the library, this type uses dynamic memory.
+/// Not available if `PERTURB_DISABLE_IO` is defined.
+class TleReader {
+public:
+    /// Memory-map a TLE file and find all the records in it.
+    ///
+    /// @param path Path to the TLE file, check `is_open` to see if it worked
+    explicit TleReader(const char *path);
+
+    /// Find all the records in a buffer of TLE text, without copying it.
+    ///
+    /// @param data Buffer of TLE text, which must outlive the reader
+    /// @param size Length of the buffer in bytes
+    TleReader(const char *data, std::size_t size);
+
+    /// Unmap the file, if any
+    ~TleReader();
+
+    TleReader(const TleReader &) = delete;
+    TleReader &operator=(const TleReader &) = delete;
+
+    /// Whether the file could be opened and mapped
+    bool is_open() const;
+
+    /// Number of TLE records found
+    std::size_t size() const;
+
+    /// Parse and initialize every TLE record.
+    ///
+    /// The records are parsed across multiple threads, and then initialized
+    /// with `perturb::init_satellites`. Records that fail to parse or
+    /// initialize don't stop the rest from being loaded, and each one's
+    /// errors are reported in `out_results`. Only records with neither a parse
+    /// nor an init error are added to `out_sats`, in the same order as the file.
+    ///
+    /// @param out_sats Loaded satellites are appended to this
+    /// @param out_results Replaced with one result per record, in file order
+    /// @param grav_model Gravity constants to use (default `GravModel::WGS72`)
+    /// @param n_threads Number of threads, or 0 to use the hardware concurrency.
+    ///                  Always 1 if `PERTURB_DISABLE_THREADS` is defined.
+    /// @return Number of records that failed to load
+    std::size_t read(
+        std::vector<Satellite> &out_sats, std::vector<TleReadResult> &out_results,
+        GravModel grav_model = GravModel::WGS72, std::size_t n_threads = 0
+    ) const;
+
+private:
+    /// Position of one TLE record's lines in the buffer
+    struct Record {
+        std::size_t line_number;
+        const char *name;
+        std::size_t name_len;
+        const char *line_1, *line_2;
+        std::size_t len_1, len_2;
+    };
+
+    void find_records();
+
+    std::unique_ptr<MappedFile> file_;  ///< Mapped file, if not reading a buffer
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+    bool is_open_ = false;
+    std::vector<Record> records_;
+};
+
+}  // namespace perturb
+
+#endif  // PERTURB_DISABLE_IO
+
+#endif  // PERTURB_TLE_READER_HPP
@@ -0,0 +1,845 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#include "perturb/catalog.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "common.hpp"
+#include "fast_math.hpp"
+#include "kepler.hpp"
+#include "perturb/sgp4.hpp"
+
+namespace perturb {
+
+using NearEarthColumn = std::vector<double>;
+
+namespace {
+
+/// Gravity constants of the catalog kernels, read from the columns (or the
+/// per-lane arrays) they point to
+struct ColumnGrav {
+    static double xke(const double *column, const std::size_t i) {
+        return column[i];
+    }
+    static double j2(const double *column, const std::size_t i) {
+        return column[i];
+    }
+    static double radiusearthkm(const double *column, const std::size_t i) {
+        return column[i];
+    }
+};
+
+/// Gravity constants of the catalog kernels, fixed to a single model
+template <GravModel Model>
+struct FixedGrav {
+    static double xke(const double *, std::size_t) {
+        return GravConstants<Model>::xke();
+    }
+    static double j2(const double *, std::size_t) {
+        return GravConstants<Model>::j2();
+    }
+    static double radiusearthkm(const double *, std::size_t) {
+        return GravConstants<Model>::radiusearthkm();
+    }
+};
+
+/// Column starting at a block, or `nullptr` for the empty gravity columns
+const double *column_at(const NearEarthColumn &column, const std::size_t first) {
+    return column.empty() ? nullptr : column.data() + first;
+}
+
+/// If a record has the exact constants the near-Earth kernel uses from a model
+template <GravModel Model>
+bool has_grav_constants(const sgp4::elsetrec &rec) {
+    using G = GravConstants<Model>;
+    return rec.xke == G::xke() && rec.j2 == G::j2()
+        && rec.radiusearthkm == G::radiusearthkm();
+}
+
+#ifdef PERTURB_ENABLE_STATS
+/// Add the counters that went up from `before` to `after` to `out`
+void add_difference(
+    const PropagationStats &after, const PropagationStats &before,
+    PropagationStats &out
+) {
+    out.n_inits += after.n_inits - before.n_inits;
+    out.init_nanos += after.init_nanos - before.init_nanos;
+    out.n_propagations += after.n_propagations - before.n_propagations;
+    out.propagate_nanos += after.propagate_nanos - before.propagate_nanos;
+    out.dspace_steps += after.dspace_steps - before.dspace_steps;
+    out.kepler_iterations += after.kepler_iterations - before.kepler_iterations;
+    out.kepler_capped += after.kepler_capped - before.kepler_capped;
+    out.lyddane += after.lyddane - before.lyddane;
+    for (std::size_t k = 0; k < N_SGP4_ERRORS; ++k) {
+        out.errors[k] += after.errors[k] - before.errors[k];
+    }
+}
+#endif  // PERTURB_ENABLE_STATS
+
+/// Find which model a record's constants came from
+bool find_grav_model(const sgp4::elsetrec &rec, GravModel &out) {
+    if (has_grav_constants<GravModel::WGS72>(rec)) {
+        out = GravModel::WGS72;
+    } else if (has_grav_constants<GravModel::WGS84>(rec)) {
+        out = GravModel::WGS84;
+    } else if (has_grav_constants<GravModel::WGS72_OLD>(rec)) {
+        out = GravModel::WGS72_OLD;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// Stand-in for a deep-space lane that failed before the Kepler solve, which is
+/// a circular orbit that converges at once (its results are dropped anyway)
+constexpr sgp4::elsetrec_periodics FAILED_LANE = {
+    1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0
+};
+
+/// A block of lanes from the long period periodics through to the final state
+template <typename Real>
+struct LaneBlock {
+    // Mean elements with the long period periodics added
+    Real am[CATALOG_LANES], nm[CATALOG_LANES], axnl[CATALOG_LANES];
+    Real aynl[CATALOG_LANES], u[CATALOG_LANES], xincp[CATALOG_LANES];
+    Real nodep[CATALOG_LANES], sinip[CATALOG_LANES], cosip[CATALOG_LANES];
+    // Each points to one value per lane, the gravity constants only for `ColumnGrav`
+    const double *con41, *x1mth2, *x7thm1;
+    const double *xke, *j2, *radiusearthkm;
+    int error[CATALOG_LANES];  ///< Error so far, updated to the final error
+    // Returned position and velocity in [km] and [km/s]
+    Real r[3][CATALOG_LANES], v[3][CATALOG_LANES];
+    unsigned kepler_iterations[CATALOG_LANES];
+    bool kepler_capped[CATALOG_LANES];
+};
+
+// Back half of SGP4 for a block of lanes, from the Kepler solve through the
+// short period periodics, transcribed from `perturb::sgp4::sgp4`. Errors are
+// evaluated with the same priority as the early returns in the original.
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+template <typename Real, typename Grav>
+void finish_lanes(LaneBlock<Real> &b) {
+    constexpr std::size_t L = CATALOG_LANES;
+    const auto narrow = [](const double x) { return static_cast<Real>(x); };
+
+    /* --------------------- solve kepler's equation --------------- */
+    Real sineo1[L], coseo1[L];
+    solve_kepler(
+        b.u, b.axnl, b.aynl, sineo1, coseo1, b.kepler_iterations, b.kepler_capped
+    );
+
+    /* ------------- short period preliminary quantities ----------- */
+    for (std::size_t l = 0; l < L; ++l) {
+        const Real am = b.am[l];
+        const Real nm = b.nm[l];
+        const Real axnl = b.axnl[l];
+        const Real aynl = b.aynl[l];
+        const Real j2 = narrow(Grav::j2(b.j2, l));
+        const Real con41 = narrow(b.con41[l]);
+        const Real x1mth2 = narrow(b.x1mth2[l]);
+        const Real x7thm1 = narrow(b.x7thm1[l]);
+        const Real xke = narrow(Grav::xke(b.xke, l));
+        const Real radiusearthkm = narrow(Grav::radiusearthkm(b.radiusearthkm, l));
+
+        const Real ecose = axnl * coseo1[l] + aynl * sineo1[l];
+        const Real esine = axnl * sineo1[l] - aynl * coseo1[l];
+        const Real el2 = axnl * axnl + aynl * aynl;
+        const Real pl = am * (Real(1.0) - el2);
+        b.error[l] = (b.error[l] == 0 && pl < Real(0.0)) ? 4 : b.error[l];
+
+        const Real rl = am * (Real(1.0) - ecose);
+        const Real rdotl = std::sqrt(am) * esine / rl;
+        const Real rvdotl = std::sqrt(pl) / rl;
+        const Real betal = std::sqrt(Real(1.0) - el2);
+        Real temp = esine / (Real(1.0) + betal);
+        const Real sinu = am / rl * (sineo1[l] - aynl - axnl * temp);
+        const Real cosu = am / rl * (coseo1[l] - axnl + aynl * temp);
+        const Real sin2u = (cosu + cosu) * sinu;
+        const Real cos2u = Real(1.0) - Real(2.0) * sinu * sinu;
+        temp = Real(1.0) / pl;
+        const Real temp1 = Real(0.5) * j2 * temp;
+        const Real temp2 = temp1 * temp;
+
+        /* -------------- update for short period periodics ------------ */
+        const Real mrt = rl * (Real(1.0) - Real(1.5) * temp2 * betal * con41)
+            + Real(0.5) * temp1 * x1mth2 * cos2u;
+        const Real dsu = -Real(0.25) * temp2 * x7thm1 * sin2u;
+        const Real xnode = b.nodep[l] + Real(1.5) * temp2 * b.cosip[l] * sin2u;
+        const Real xinc =
+            b.xincp[l] + Real(1.5) * temp2 * b.cosip[l] * b.sinip[l] * cos2u;
+        const Real mvt = rdotl - nm * temp1 * x1mth2 * sin2u / xke;
+        const Real rvdot =
+            rvdotl + nm * temp1 * (x1mth2 * cos2u + Real(1.5) * con41) / xke;
+
+        /* --------------------- orientation vectors ------------------- */
+#ifdef PERTURB_ENABLE_FAST_MATH
+        // Rotate the unit (sinu, cosu) by `dsu`, instead of taking its angle
+        const Real unit = Real(1.0) / std::sqrt(sinu * sinu + cosu * cosu);
+        Real sindsu, cosdsu;
+        hot_sincos(dsu, sindsu, cosdsu);
+        const Real sinsu = unit * (sinu * cosdsu + cosu * sindsu);
+        const Real cossu = unit * (cosu * cosdsu - sinu * sindsu);
+#else
+        const Real su = std::atan2(sinu, cosu) + dsu;
+        const Real sinsu = std::sin(su);
+        const Real cossu = std::cos(su);
+#endif
+        Real snod, cnod, sini, cosi;
+        hot_sincos(xnode, snod, cnod);
+        hot_sincos(xinc, sini, cosi);
+        const Real xmx = -snod * cosi;
+        const Real xmy = cnod * cosi;
+        const Real ux = xmx * sinsu + cnod * cossu;
+        const Real uy = xmy * sinsu + snod * cossu;
+        const Real uz = sini * sinsu;
+        const Real vx = xmx * cossu - cnod * sinsu;
+        const Real vy = xmy * cossu - snod * sinsu;
+        const Real vz = sini * cossu;
+
+        /* --------- position and velocity (in km and km/sec) ---------- */
+        const Real vkmpersec = radiusearthkm * xke / Real(60.0);
+        b.r[0][l] = (mrt * ux) * radiusearthkm;
+        b.r[1][l] = (mrt * uy) * radiusearthkm;
+        b.r[2][l] = (mrt * uz) * radiusearthkm;
+        b.v[0][l] = (mvt * ux + rvdot * vx) * vkmpersec;
+        b.v[1][l] = (mvt * uy + rvdot * vy) * vkmpersec;
+        b.v[2][l] = (mvt * uz + rvdot * vz) * vkmpersec;
+
+        // sgp4fix for decaying satellites
+        b.error[l] = (b.error[l] == 0 && mrt < Real(1.0)) ? 6 : b.error[l];
+    }
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+
+/// Store into element `at` of a column, unless it's left out
+template <typename Real>
+void store(double *column, const std::size_t at, const Real value) {
+    if (column) {
+        column[at] = static_cast<double>(value);
+    }
+}
+
+}  // namespace
+
+struct SatelliteCatalog::StateSink {
+    StateVector *sv;              ///< State vectors, or `nullptr` to use `columns`
+    const StateColumns *columns;  ///< Columns, only if `sv` is `nullptr`
+
+    /// Write the result of lane `l` of a block as catalog satellite `i`
+    template <typename Real>
+    void write(
+        const std::size_t i, const JulianDate jd, const LaneBlock<Real> &b,
+        const std::size_t l
+    ) const {
+        if (sv) {
+            StateVector &out = sv[i];
+            out.epoch = jd;
+            for (std::size_t k = 0; k < 3; ++k) {
+                out.position[k] = static_cast<double>(b.r[k][l]);
+                out.velocity[k] = static_cast<double>(b.v[k][l]);
+            }
+            return;
+        }
+        const std::size_t at = i * columns->stride;
+        store(columns->x, at, b.r[0][l]);
+        store(columns->y, at, b.r[1][l]);
+        store(columns->z, at, b.r[2][l]);
+        store(columns->vx, at, b.v[0][l]);
+        store(columns->vy, at, b.v[1][l]);
+        store(columns->vz, at, b.v[2][l]);
+    }
+};
+
+SatelliteCatalog::SatelliteCatalog() = default;
+
+SatelliteCatalog::SatelliteCatalog(const std::vector<Satellite> &sats) {
+    sats_.reserve(sats.size());
+    for (const auto &sat : sats) {
+        add(sat);
+    }
+}
+
+#ifndef PERTURB_DISABLE_IO
+SatelliteCatalog SatelliteCatalog::load(
+    const char *path, std::vector<TleReadResult> *out_results,
+    const GravModel grav_model, const std::size_t n_threads
+) {
+    const TleReader reader(path);
+    std::vector<Satellite> sats;
+    std::vector<TleReadResult> results;
+    (void) reader.read(sats, results, grav_model, n_threads);
+    if (out_results) {
+        out_results->swap(results);
+    }
+    return SatelliteCatalog(sats);
+}
+#endif  // PERTURB_DISABLE_IO
+
+void SatelliteCatalog::add(const Satellite &sat) {
+    const std::size_t idx = sats_.size();
+    sats_.push_back(sat);
+#ifdef PERTURB_ENABLE_STATS
+    stats_.emplace_back();
+#endif
+    const sgp4::elsetrec &rec = sat.sat_rec;
+    if (rec.method != 'n') {
+        deep_idx_.push_back(idx);
+        deep_recs_.emplace_back();
+        sgp4::compact_elsetrec(rec, deep_recs_.back());
+        deep_states_.push_back(sgp4::elsetrec_state {});
+        return;
+    }
+
+    // The simplified drag equations (`isimp == 1`) skip a few terms. Zeroing
+    // their coefficients makes those terms vanish exactly, so the kernel
+    // doesn't need a branch per lane.
+    const bool simple = (rec.isimp == 1);
+    // clang-format off
+    const struct {
+        NearEarthColumn NearEarthColumns::*column;
+        double value;
+    } fields[] = {
+        { &NearEarthColumns::jdsatepoch, rec.jdsatepoch },
+        { &NearEarthColumns::jdsatepochF, rec.jdsatepochF },
+        { &NearEarthColumns::mo, rec.mo },
+        { &NearEarthColumns::mdot, rec.mdot },
+        { &NearEarthColumns::argpo, rec.argpo },
+        { &NearEarthColumns::argpdot, rec.argpdot },
+        { &NearEarthColumns::nodeo, rec.nodeo },
+        { &NearEarthColumns::nodedot, rec.nodedot },
+        { &NearEarthColumns::nodecf, rec.nodecf },
+        { &NearEarthColumns::bstar, rec.bstar },
+        { &NearEarthColumns::cc1, rec.cc1 },
+        { &NearEarthColumns::cc4, rec.cc4 },
+        { &NearEarthColumns::cc5, simple ? 0.0 : rec.cc5 },
+        { &NearEarthColumns::t2cof, rec.t2cof },
+        { &NearEarthColumns::t3cof, rec.t3cof },
+        { &NearEarthColumns::t4cof, rec.t4cof },
+        { &NearEarthColumns::t5cof, rec.t5cof },
+        { &NearEarthColumns::d2, rec.d2 },
+        { &NearEarthColumns::d3, rec.d3 },
+        { &NearEarthColumns::d4, rec.d4 },
+        { &NearEarthColumns::omgcof, simple ? 0.0 : rec.omgcof },
+        { &NearEarthColumns::xmcof, simple ? 0.0 : rec.xmcof },
+        { &NearEarthColumns::eta, rec.eta },
+        { &NearEarthColumns::delmo, rec.delmo },
+        { &NearEarthColumns::sinmao, rec.sinmao },
+        { &NearEarthColumns::no_unkozai, rec.no_unkozai },
+        { &NearEarthColumns::ecco, rec.ecco },
+        { &NearEarthColumns::inclo, rec.inclo },
+        { &NearEarthColumns::aycof, rec.aycof },
+        { &NearEarthColumns::xlcof, rec.xlcof },
+        { &NearEarthColumns::con41, rec.con41 },
+        { &NearEarthColumns::x1mth2, rec.x1mth2 },
+        { &NearEarthColumns::x7thm1, rec.x7thm1 },
+    };
+    const struct {
+        NearEarthColumn NearEarthColumns::*column;
+        double sgp4::elsetrec::*field;
+    } grav_fields[] = {
+        { &NearEarthColumns::xke, &sgp4::elsetrec::xke },
+        { &NearEarthColumns::j2, &sgp4::elsetrec::j2 },
+        { &NearEarthColumns::radiusearthkm, &sgp4::elsetrec::radiusearthkm },
+    };
+    // clang-format on
+
+    // Drop the old padding, append, and then re-pad with the new last satellite
+    const std::size_t n_near = near_idx_.size() + 1;
+    const std::size_t n_padded =
+        ((n_near + CATALOG_LANES - 1) / CATALOG_LANES) * CATALOG_LANES;
+    for (const auto &field : fields) {
+        NearEarthColumn &column = near_.*field.column;
+        column.resize(n_near - 1);
+        column.push_back(field.value);
+        column.resize(n_padded, field.value);
+    }
+    near_idx_.push_back(idx);
+
+    // The gravity constants only get columns once the models are mixed, and
+    // then they're filled in for every satellite added before that too
+    const bool was_uniform = near_grav_uniform_ || (n_near == 1);
+    GravModel model = near_grav_model_;
+    near_grav_uniform_ = find_grav_model(rec, model)
+        && (n_near == 1 || (near_grav_uniform_ && model == near_grav_model_));
+    near_grav_model_ = model;
+    if (!near_grav_uniform_) {
+        const std::size_t n_filled = was_uniform ? 0 : n_near - 1;
+        for (const auto &grav : grav_fields) {
+            NearEarthColumn &column = near_.*grav.column;
+            column.resize(n_filled);
+            for (std::size_t k = n_filled; k < n_near; ++k) {
+                column.push_back(sats_[near_idx_[k]].sat_rec.*grav.field);
+            }
+            column.resize(n_padded, column.back());
+        }
+    }
+}
+
+std::size_t SatelliteCatalog::size() const {
+    return sats_.size();
+}
+
+std::size_t SatelliteCatalog::near_earth_size() const {
+    return near_idx_.size();
+}
+
+const Satellite &SatelliteCatalog::operator[](const std::size_t i) const {
+    return sats_[i];
+}
+
+bool SatelliteCatalog::grav_model(GravModel &out) const {
+    if (near_grav_uniform_) {
+        out = near_grav_model_;
+    }
+    return near_grav_uniform_;
+}
+
+bool SatelliteCatalog::stats(const std::size_t i, PropagationStats &out) const {
+#ifdef PERTURB_ENABLE_STATS
+    out = stats_[i];
+    return true;
+#else
+    (void) i;
+    (void) out;
+    return false;
+#endif
+}
+
+void SatelliteCatalog::reset_stats() {
+    std::fill(stats_.begin(), stats_.end(), PropagationStats());
+}
+
+std::size_t SatelliteCatalog::propagate(
+    const JulianDate jd, StateVector *out_sv, Sgp4Error *out_err,
+    const CatalogPrecision precision
+) {
+    return propagate_into(jd, StateSink { out_sv, nullptr }, out_err, precision);
+}
+
+std::size_t SatelliteCatalog::propagate(
+    const JulianDate jd, const StateColumns &out, Sgp4Error *out_err,
+    const CatalogPrecision precision
+) {
+    return propagate_into(jd, StateSink { nullptr, &out }, out_err, precision);
+}
+
+std::size_t SatelliteCatalog::propagate_into(
+    const JulianDate jd, const StateSink &out, Sgp4Error *out_err,
+    const CatalogPrecision precision
+) {
+    const NearEarthKernel kernel = near_earth_kernel(precision);
+    PropagationStats *const sat_stats = stats_.empty() ? nullptr : stats_.data();
+    std::size_t n_failed = 0;
+    for (std::size_t first = 0; first < near_idx_.size(); first += CATALOG_LANES) {
+        n_failed += (this->*kernel)(
+            first, first, near_idx_.size(), jd, out, out_err, sat_stats
+        );
+    }
+    for (std::size_t k = 0; k < deep_idx_.size(); k += CATALOG_LANES) {
+        const std::size_t n = std::min(CATALOG_LANES, deep_idx_.size() - k);
+        n_failed += propagate_deep_block(
+            k, n, jd, deep_states_.data() + k, out, out_err, sat_stats
+        );
+    }
+    return n_failed;
+}
+
+std::size_t SatelliteCatalog::propagate_grid(
+    const std::size_t first, const std::size_t last, const JulianDate *times,
+    const std::size_t n_times, StateVector *out_sv, Sgp4Error *out_err,
+    const CatalogPrecision precision
+) const {
+    const NearEarthKernel kernel = near_earth_kernel(precision);
+    const std::size_t stride = sats_.size();
+    std::size_t n_failed = 0;
+
+    // Near-Earth columns belonging to satellites in `[first, last)`
+    const auto near_begin = static_cast<std::size_t>(
+        std::lower_bound(near_idx_.begin(), near_idx_.end(), first) - near_idx_.begin()
+    );
+    const auto near_end = static_cast<std::size_t>(
+        std::lower_bound(near_idx_.begin(), near_idx_.end(), last) - near_idx_.begin()
+    );
+    const std::size_t block_begin = (near_begin / CATALOG_LANES) * CATALOG_LANES;
+    for (std::size_t block = block_begin; block < near_end; block += CATALOG_LANES) {
+        for (std::size_t k = 0; k < n_times; ++k) {
+            const StateSink out { out_sv + k * stride, nullptr };
+            n_failed += (this->*kernel)(
+                block, near_begin, near_end, times[k], out,
+                out_err ? out_err + k * stride : nullptr, nullptr
+            );
+        }
+    }
+
+    // Deep-space satellites keep their state across all the times, so the
+    // resonance integrator can carry on instead of restarting from epoch
+    const auto deep_begin = static_cast<std::size_t>(
+        std::lower_bound(deep_idx_.begin(), deep_idx_.end(), first) - deep_idx_.begin()
+    );
+    const auto deep_end = static_cast<std::size_t>(
+        std::lower_bound(deep_idx_.begin(), deep_idx_.end(), last) - deep_idx_.begin()
+    );
+    for (std::size_t block = deep_begin; block < deep_end; block += CATALOG_LANES) {
+        const std::size_t n = std::min(CATALOG_LANES, deep_end - block);
+        sgp4::elsetrec_state states[CATALOG_LANES] = {};
+        for (std::size_t k = 0; k < n_times; ++k) {
+            const StateSink out { out_sv + k * stride, nullptr };
+            n_failed += propagate_deep_block(
+                block, n, times[k], states, out,
+                out_err ? out_err + k * stride : nullptr, nullptr
+            );
+        }
+    }
+    return n_failed;
+}
+
+SatelliteCatalog::NearEarthKernel SatelliteCatalog::near_earth_kernel(
+    const CatalogPrecision precision
+) const {
+    const bool mixed = (precision == CatalogPrecision::MIXED);
+    if (!near_grav_uniform_) {
+        return mixed ? &SatelliteCatalog::propagate_near_earth_block<float, ColumnGrav>
+                     : &SatelliteCatalog::propagate_near_earth_block<double, ColumnGrav>;
+    }
+    switch (near_grav_model_) {
+        case GravModel::WGS72_OLD: {
+            using Grav = FixedGrav<GravModel::WGS72_OLD>;
+            return mixed ? &SatelliteCatalog::propagate_near_earth_block<float, Grav>
+                         : &SatelliteCatalog::propagate_near_earth_block<double, Grav>;
+        }
+        case GravModel::WGS84: {
+            using Grav = FixedGrav<GravModel::WGS84>;
+            return mixed ? &SatelliteCatalog::propagate_near_earth_block<float, Grav>
+                         : &SatelliteCatalog::propagate_near_earth_block<double, Grav>;
+        }
+        case GravModel::WGS72:
+        default: {
+            using Grav = FixedGrav<GravModel::WGS72>;
+            return mixed ? &SatelliteCatalog::propagate_near_earth_block<float, Grav>
+                         : &SatelliteCatalog::propagate_near_earth_block<double, Grav>;
+        }
+    }
+}
+
+// Near-Earth SGP4, transcribed from `perturb::sgp4::sgp4` for `CATALOG_LANES`
+// satellites at once, with `finish_lanes` for everything from the Kepler solve
+// on. Every expression is kept in the same form as the original, except for
+// the batched solver and its sine and cosine, so with `Real = double` each
+// lane agrees with the original to within rounding. Errors are evaluated with
+// the same priority as the early returns in the original.
+//
+// With `Real = float`, everything up to the reduction of the angles to
+// [0, 2pi) stays in double, since the time since epoch and the secular angles
+// grow without bound. Only the long period periodics and everything after
+// them, which hold most of the transcendental calls, run in single precision.
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+template <typename Real, typename Grav>
+std::size_t SatelliteCatalog::propagate_near_earth_block(
+    const std::size_t first, const std::size_t col_begin, const std::size_t col_end,
+    const JulianDate jd, const StateSink &out, Sgp4Error *out_err,
+    PropagationStats *out_stats
+) const {
+    constexpr std::size_t L = CATALOG_LANES;
+#ifdef PERTURB_ENABLE_STATS
+    const auto start = std::chrono::steady_clock::now();
+#else
+    (void) out_stats;
+#endif
+    const double twopi = 2.0 * PI;
+    const double x2o3 = 2.0 / 3.0;
+    const NearEarthColumns &c = near_;
+    const auto narrow = [](const double x) { return static_cast<Real>(x); };
+
+    double t[L], tempa[L], tempe[L], templ[L], mm[L], argpm[L], nodem[L];
+    for (std::size_t l = 0; l < L; ++l) {
+        const std::size_t i = first + l;
+        // Same grouping as `JulianDate::operator-`, so results match `propagate`
+        const double delta_jd =
+            (jd.jd - c.jdsatepoch[i]) + (jd.jd_frac - c.jdsatepochF[i]);
+        t[l] = delta_jd * MINS_PER_DAY;
+    }
+
+    /* ------- update for secular gravity and atmospheric drag ----- */
+    for (std::size_t l = 0; l < L; ++l) {
+        const std::size_t i = first + l;
+        const double xmdf = c.mo[i] + c.mdot[i] * t[l];
+        const double argpdf = c.argpo[i] + c.argpdot[i] * t[l];
+        const double nodedf = c.nodeo[i] + c.nodedot[i] * t[l];
+        const double t2 = t[l] * t[l];
+        nodem[l] = nodedf + c.nodecf[i] * t2;
+        tempa[l] = 1.0 - c.cc1[i] * t[l];
+        tempe[l] = c.bstar[i] * c.cc4[i] * t[l];
+        templ[l] = c.t2cof[i] * t2;
+
+        const double delomg = c.omgcof[i] * t[l];
+        const double delmtemp = 1.0 + c.eta[i] * std::cos(xmdf);
+        const double delm =
+            c.xmcof[i] * (delmtemp * delmtemp * delmtemp - c.delmo[i]);
+        const double temp = delomg + delm;
+        mm[l] = xmdf + temp;
+        argpm[l] = argpdf - temp;
+        const double t3 = t2 * t[l];
+        const double t4 = t3 * t[l];
+        tempa[l] = tempa[l] - c.d2[i] * t2 - c.d3[i] * t3 - c.d4[i] * t4;
+        tempe[l] = tempe[l] + c.bstar[i] * c.cc5[i] * (std::sin(mm[l]) - c.sinmao[i]);
+        templ[l] = templ[l] + c.t3cof[i] * t3 + t4 * (c.t4cof[i] + t[l] * c.t5cof[i]);
+    }
+
+    int error[L];
+    double am[L], nm[L], em[L];
+    for (std::size_t l = 0; l < L; ++l) {
+        const std::size_t i = first + l;
+        nm[l] = c.no_unkozai[i];
+        em[l] = c.ecco[i];
+        const bool bad_nm = (nm[l] <= 0.0);
+        const double xke = Grav::xke(c.xke.data(), i);
+        am[l] = std::pow((xke / nm[l]), x2o3) * tempa[l] * tempa[l];
+        nm[l] = xke / std::pow(am[l], 1.5);
+        em[l] = em[l] - tempe[l];
+        const bool bad_em = (em[l] >= 1.0) || (em[l] < -0.001);
+        error[l] = bad_nm ? 2 : (bad_em ? 1 : 0);
+        em[l] = (em[l] < 1.0e-6) ? 1.0e-6 : em[l];
+    }
+
+    LaneBlock<Real> b;
+    double xl[L];
+    for (std::size_t l = 0; l < L; ++l) {
+        const std::size_t i = first + l;
+        mm[l] = mm[l] + c.no_unkozai[i] * templ[l];
+        double xlm = mm[l] + argpm[l] + nodem[l];
+
+        nodem[l] = hot_fmod(nodem[l], twopi);
+        argpm[l] = hot_fmod(argpm[l], twopi);
+        xlm = hot_fmod(xlm, twopi);
+        mm[l] = hot_fmod(xlm - argpm[l] - nodem[l], twopi);
+        xl[l] = mm[l] + argpm[l] + nodem[l];
+        b.am[l] = narrow(am[l]);
+        b.nm[l] = narrow(nm[l]);
+        b.error[l] = error[l];
+    }
+
+    for (std::size_t l = 0; l < L; ++l) {
+        const std::size_t i = first + l;
+        /* ----------------- compute extra mean quantities ------------- */
+        const Real inclm = narrow(c.inclo[i]);
+        lane_sincos(inclm, b.sinip[l], b.cosip[l]);
+        b.xincp[l] = inclm;
+        b.nodep[l] = narrow(nodem[l]);
+
+        /* -------------------- long period periodics ------------------ */
+        const Real ep = narrow(em[l]);
+        Real sinargpp, cosargpp;
+        lane_sincos(narrow(argpm[l]), sinargpp, cosargpp);
+        b.axnl[l] = ep * cosargpp;
+        const Real temp = Real(1.0) / (b.am[l] * (Real(1.0) - ep * ep));
+        b.aynl[l] = ep * sinargpp + temp * narrow(c.aycof[i]);
+        xl[l] = xl[l] + static_cast<double>(temp * narrow(c.xlcof[i]) * b.axnl[l]);
+    }
+    for (std::size_t l = 0; l < L; ++l) {
+        b.u[l] = narrow(hot_fmod(xl[l] - nodem[l], twopi));
+    }
+
+    b.con41 = c.con41.data() + first;
+    b.x1mth2 = c.x1mth2.data() + first;
+    b.x7thm1 = c.x7thm1.data() + first;
+    b.xke = column_at(c.xke, first);
+    b.j2 = column_at(c.j2, first);
+    b.radiusearthkm = column_at(c.radiusearthkm, first);
+    finish_lanes<Real, Grav>(b);
+
+    // Scatter the requested real (non-padding) lanes back into catalog order
+    std::size_t n_failed = 0;
+    const std::size_t l_begin = std::max(first, col_begin) - first;
+    const std::size_t l_end = std::min(first + L, col_end) - first;
+    for (std::size_t l = l_begin; l < l_end; ++l) {
+        n_failed += (b.error[l] != 0) ? 1U : 0U;
+        out.write(near_idx_[first + l], jd, b, l);
+        if (out_err) {
+            out_err[near_idx_[first + l]] = convert_sgp4_error_code(b.error[l]);
+        }
+    }
+
+#ifdef PERTURB_ENABLE_STATS
+    // Count the real lanes like separate calls, splitting the time between them
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start
+    );
+    const auto lane_nanos = static_cast<std::uint64_t>(elapsed.count())
+        / std::max<std::uint64_t>(1, l_end - l_begin);
+    for (std::size_t l = l_begin; l < l_end; ++l) {
+        PropagationStats lane;
+        count_propagation(lane, b.error[l]);
+        lane.propagate_nanos = lane_nanos;
+        lane.kepler_iterations = b.kepler_iterations[l];
+        lane.kepler_capped = b.kepler_capped[l] ? 1U : 0U;
+        local_stats() += lane;
+        if (out_stats) {
+            out_stats[near_idx_[first + l]] += lane;
+        }
+    }
+#endif
+    return n_failed;
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+std::size_t SatelliteCatalog::propagate_deep_block(
+    const std::size_t first, const std::size_t n, const JulianDate jd,
+    sgp4::elsetrec_state *states, const StateSink &out, Sgp4Error *out_err,
+    PropagationStats *out_stats
+) const {
+    constexpr std::size_t L = CATALOG_LANES;
+#ifdef PERTURB_ENABLE_STATS
+    using Clock = std::chrono::steady_clock;
+    PropagationStats front[L];
+    std::uint64_t front_nanos[L] = {};
+#else
+    (void) out_stats;
+#endif
+    const double twopi = 2.0 * PI;
+    LaneBlock<double> b;
+    double con41[L], x1mth2[L], x7thm1[L], xke[L], j2[L], radiusearthkm[L];
+    bool front_ok[L];
+    for (std::size_t l = 0; l < L; ++l) {
+        // Pad a partial block by repeating the first lane, without running it again
+        const std::size_t p = (l < n) ? l : 0;
+        const sgp4::elsetrec_compact &rec = deep_recs_[first + p];
+        if (l < n) {
+#ifdef PERTURB_ENABLE_STATS
+            const PropagationStats before = local_stats();
+            const auto start = Clock::now();
+#endif
+            const double delta_jd = jd - JulianDate(rec.jdsatepoch, rec.jdsatepochF);
+            // Only written on success, so failed lanes keep the stand-in
+            sgp4::elsetrec_periodics lp = FAILED_LANE;
+            front_ok[l] =
+                sgp4::sgp4_long_period(rec, states[l], delta_jd * MINS_PER_DAY, lp);
+            b.error[l] = states[l].error;
+            b.am[l] = lp.am;
+            b.nm[l] = lp.nm;
+            b.axnl[l] = lp.axnl;
+            b.aynl[l] = lp.aynl;
+            b.u[l] = hot_fmod(lp.xl - lp.nodep, twopi);
+            b.xincp[l] = lp.xincp;
+            b.nodep[l] = lp.nodep;
+            b.sinip[l] = lp.sinip;
+            b.cosip[l] = lp.cosip;
+            const double cosisq = lp.cosip * lp.cosip;
+            states[l].con41 = con41[l] = 3.0 * cosisq - 1.0;
+            states[l].x1mth2 = x1mth2[l] = 1.0 - cosisq;
+            states[l].x7thm1 = x7thm1[l] = 7.0 * cosisq - 1.0;
+#ifdef PERTURB_ENABLE_STATS
+            using std::chrono::nanoseconds;
+            const auto front_elapsed =
+                std::chrono::duration_cast<nanoseconds>(Clock::now() - start);
+            front_nanos[l] = static_cast<std::uint64_t>(front_elapsed.count());
+            add_difference(local_stats(), before, front[l]);
+#endif
+        } else {
+            front_ok[l] = front_ok[p];
+            b.error[l] = b.error[p];
+            b.am[l] = b.am[p];
+            b.nm[l] = b.nm[p];
+            b.axnl[l] = b.axnl[p];
+            b.aynl[l] = b.aynl[p];
+            b.u[l] = b.u[p];
+            b.xincp[l] = b.xincp[p];
+            b.nodep[l] = b.nodep[p];
+            b.sinip[l] = b.sinip[p];
+            b.cosip[l] = b.cosip[p];
+            con41[l] = con41[p];
+            x1mth2[l] = x1mth2[p];
+            x7thm1[l] = x7thm1[p];
+        }
+        xke[l] = rec.xke;
+        j2[l] = rec.j2;
+        radiusearthkm[l] = rec.radiusearthkm;
+    }
+
+#ifdef PERTURB_ENABLE_STATS
+    const auto start = Clock::now();
+#endif
+    b.con41 = con41;
+    b.x1mth2 = x1mth2;
+    b.x7thm1 = x7thm1;
+    b.xke = xke;
+    b.j2 = j2;
+    b.radiusearthkm = radiusearthkm;
+    finish_lanes<double, ColumnGrav>(b);
+
+    std::size_t n_failed = 0;
+    for (std::size_t l = 0; l < n; ++l) {
+        states[l].error = b.error[l];
+        n_failed += (b.error[l] != 0) ? 1U : 0U;
+        const std::size_t idx = deep_idx_[first + l];
+        out.write(idx, jd, b, l);
+        if (out_err) {
+            out_err[idx] = convert_sgp4_error_code(b.error[l]);
+        }
+    }
+
+#ifdef PERTURB_ENABLE_STATS
+    // Each lane gets the time of its own front, and an even split of the rest
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    const auto lane_nanos = static_cast<std::uint64_t>(elapsed.count()) / n;
+    for (std::size_t l = 0; l < n; ++l) {
+        PropagationStats lane;
+        count_propagation(lane, b.error[l]);
+        lane.propagate_nanos = front_nanos[l] + lane_nanos;
+        lane.kepler_iterations = front_ok[l] ? b.kepler_iterations[l] : 0U;
+        lane.kepler_capped = (front_ok[l] && b.kepler_capped[l]) ? 1U : 0U;
+        local_stats() += lane;
+        if (out_stats) {
+            lane += front[l];
+            out_stats[deep_idx_[first + l]] += lane;
+        }
+    }
+#endif
+    return n_failed;
+}
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
+
+std::size_t init_satellites(
+    const TwoLineElement *tles, const std::size_t n_tles,
+    std::vector<Satellite> &out_sats, Sgp4Error *out_err, const GravModel grav_model,
+    const std::size_t n_threads
+) {
+    // Small enough to balance deep-space satellites, big enough to not contend
+    constexpr std::size_t INIT_BLOCK_SATS = 32;
+
+    const std::size_t offset = out_sats.size();
+    out_sats.resize(offset + n_tles, Satellite(sgp4::elsetrec {}));
+    std::atomic<std::size_t> n_failed {0};
+    parallel_for_blocks(
+        n_tles, INIT_BLOCK_SATS, n_threads,
+        [&](const std::size_t begin, const std::size_t end) {
+            std::size_t block_failed = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                // Initialize in place, since the placeholder is already zeroed
+                Satellite &sat = out_sats[offset + i];
+                init_sat_rec(tles[i], grav_model, sat.sat_rec);
+                const Sgp4Error err = sat.last_error();
+                block_failed += (err != Sgp4Error::NONE) ? 1U : 0U;
+                if (out_err) {
+                    out_err[i] = err;
+                }
+            }
+            n_failed += block_failed;
+        }
+    );
+    return n_failed;
+}
+
+}  // namespace perturb
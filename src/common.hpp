@@ -0,0 +1,138 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+// Private helpers shared between the perturb source files, not installed
+
+#ifndef PERTURB_SRC_COMMON_HPP
+#define PERTURB_SRC_COMMON_HPP
+
+#include "perturb/perturb.hpp"
+#include "perturb/sgp4.hpp"
+#include "perturb/stats.hpp"
+#include "perturb/tle.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#ifdef PERTURB_ENABLE_STATS
+#  include <chrono>
+#  include <cstdint>
+#endif
+#ifndef PERTURB_DISABLE_THREADS
+#  include <atomic>
+#  include <thread>
+#  include <vector>
+#endif
+
+namespace perturb {
+
+constexpr double MINS_PER_DAY = 24 * 60;
+constexpr double SECS_PER_MIN = 60;
+constexpr double SECS_PER_DAY = 24 * 60 * 60;
+constexpr double PI = 3.14159265358979323846;
+
+inline Sgp4Error convert_sgp4_error_code(const int error_code) {
+    if (error_code < 0 || error_code >= static_cast<int>(Sgp4Error::UNKNOWN)) {
+        return Sgp4Error::UNKNOWN;
+    }
+    return static_cast<Sgp4Error>(error_code);
+}
+
+inline sgp4::gravconsttype convert_grav_model(const GravModel model) {
+    switch (model) {
+        case GravModel::WGS72_OLD: return sgp4::wgs72old;
+        case GravModel::WGS72: return sgp4::wgs72;
+        case GravModel::WGS84: return sgp4::wgs84;
+        default: return sgp4::wgs72;
+    }
+}
+
+#ifdef PERTURB_ENABLE_STATS
+/// Counters of the calling thread, which the propagation hooks add to
+PropagationStats &local_stats();
+
+/// Count a propagation and the error code it returned
+inline void count_propagation(PropagationStats &stats, const int error_code) {
+    ++stats.n_propagations;
+    ++stats.errors[static_cast<std::size_t>(convert_sgp4_error_code(error_code))];
+}
+
+/// Adds the time from construction to destruction to a counter in [ns]
+class StatsTimer {
+public:
+    explicit StatsTimer(std::uint64_t &nanos)
+        : nanos_(nanos), start_(std::chrono::steady_clock::now()) {}
+
+    ~StatsTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        nanos_ += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()
+        );
+    }
+
+    StatsTimer(const StatsTimer &) = delete;
+    StatsTimer &operator=(const StatsTimer &) = delete;
+
+private:
+    std::uint64_t &nanos_;
+    std::chrono::steady_clock::time_point start_;
+};
+#endif  // PERTURB_ENABLE_STATS
+
+/// Fill in and initialize a zeroed SGP4 record from a TLE, like `Satellite(tle)`
+void init_sat_rec(
+    const TwoLineElement &tle, GravModel grav_model, sgp4::elsetrec &sat_rec
+);
+
+/// Split `[0, n)` into blocks of `block` items and run `f(begin, end)` on each.
+///
+/// The blocks are handed out to the threads one at a time as they finish
+/// their last one, so work that varies a lot between items still gets spread
+/// out evenly. A thread count of 0 uses the hardware concurrency, and the
+/// calling thread works on blocks too. Everything runs on the calling thread
+/// if threads are disabled.
+template <typename F>
+void parallel_for_blocks(
+    const std::size_t n, const std::size_t block, std::size_t n_threads, F f
+) {
+#ifndef PERTURB_DISABLE_THREADS
+    if (n_threads == 0) {
+        n_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    n_threads = std::max<std::size_t>(1, std::min(n_threads, (n + block - 1) / block));
+    std::atomic<std::size_t> next {0};
+    const auto work = [&]() {
+        for (;;) {
+            const std::size_t begin = next.fetch_add(block);
+            if (begin >= n) {
+                return;
+            }
+            f(begin, std::min(begin + block, n));
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads - 1);
+    for (std::size_t t = 1; t < n_threads; ++t) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+#else
+    (void) block;
+    (void) n_threads;
+    f(std::size_t {0}, n);
+#endif
+}
+
+}  // namespace perturb
+
+#endif  // PERTURB_SRC_COMMON_HPP
@@ -0,0 +1,369 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#include "perturb/conjunction.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common.hpp"
+
+namespace perturb {
+
+namespace {
+
+/// Number of time steps handed to a thread at once
+constexpr std::size_t STEPS_PER_BLOCK = 8;
+
+/// Most iterations used to refine a time of closest approach
+constexpr int MAX_TCA_ITERATIONS = 16;
+
+/// Extra distance added to the straight-line test of a pair in [km]
+constexpr double CANDIDATE_MARGIN = 0.1;
+
+/// Gravitational parameter of the Earth in [km^3 / s^2], rounded up from WGS72
+constexpr double EARTH_MU = 398601.0;
+
+/// Smallest orbital radius considered, that of the Earth's surface in [km]
+constexpr double MIN_RADIUS = 6378.0;
+
+/// Largest straight-line error per [km] of separation allowed over half a step
+constexpr double MAX_TIDAL = 0.25;
+
+/// Fastest rate at which the gravity gradient bends the relative motion of two
+/// satellites away from a straight line in [1 / s]
+double tidal_rate() {
+    return std::sqrt(3.0 * EARTH_MU / (MIN_RADIUS * MIN_RADIUS * MIN_RADIUS));
+}
+
+double dot(const Vec3 &a, const Vec3 &b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+Vec3 sub(const Vec3 &a, const Vec3 &b) {
+    return Vec3 { { a[0] - b[0], a[1] - b[1], a[2] - b[2] } };
+}
+
+/// Radii of the perigee and apogee of a satellite's mean elements in [km]
+struct Shell {
+    double perigee, apogee;
+};
+
+Shell shell_of(const Satellite &sat) {
+    const sgp4::elsetrec &rec = sat.sat_rec;
+    return Shell {
+        (1.0 + rec.altp) * rec.radiusearthkm, (1.0 + rec.alta) * rec.radiusearthkm
+    };
+}
+
+/// Buckets positions into cubic cells, to find every pair in the same or
+/// adjacent cells. The cells are hashed into a table with at least twice as
+/// many buckets as positions, and the positions are counting sorted by bucket,
+/// so building and querying are both linear in the number of positions.
+class SpatialHash {
+public:
+    /// Bucket positions into cells with sides of `cell` in [km]
+    void build(const std::vector<Vec3> &pos, const double cell) {
+        const std::size_t n = pos.size();
+        std::size_t n_buckets = 16;
+        while (n_buckets < 2 * n) {
+            n_buckets *= 2;
+        }
+        mask_ = n_buckets - 1;
+        const double inv_cell = 1.0 / cell;
+        cx_.resize(n);
+        cy_.resize(n);
+        cz_.resize(n);
+        bucket_of_.resize(n);
+        start_.assign(n_buckets + 1, 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            cx_[i] = static_cast<std::int64_t>(std::floor(pos[i][0] * inv_cell));
+            cy_[i] = static_cast<std::int64_t>(std::floor(pos[i][1] * inv_cell));
+            cz_[i] = static_cast<std::int64_t>(std::floor(pos[i][2] * inv_cell));
+            bucket_of_[i] = bucket(cx_[i], cy_[i], cz_[i]);
+            ++start_[bucket_of_[i] + 1];
+        }
+        for (std::size_t b = 0; b < n_buckets; ++b) {
+            start_[b + 1] += start_[b];
+        }
+        next_.assign(start_.begin(), start_.end() - 1);
+        order_.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            order_[next_[bucket_of_[i]]++] = i;
+        }
+    }
+
+    /// Call `f(i, j)` once for every pair `i < j` in the same or adjacent cells
+    template <typename F>
+    void for_each_pair(F f) const {
+        for (std::size_t i = 0; i < cx_.size(); ++i) {
+            for (std::int64_t dx = -1; dx <= 1; ++dx) {
+                for (std::int64_t dy = -1; dy <= 1; ++dy) {
+                    for (std::int64_t dz = -1; dz <= 1; ++dz) {
+                        const std::int64_t x = cx_[i] + dx;
+                        const std::int64_t y = cy_[i] + dy;
+                        const std::int64_t z = cz_[i] + dz;
+                        const std::size_t b = bucket(x, y, z);
+                        for (std::size_t k = start_[b]; k < start_[b + 1]; ++k) {
+                            const std::size_t j = order_[k];
+                            // Other cells can share the bucket, so check the cell
+                            if (j > i && cx_[j] == x && cy_[j] == y && cz_[j] == z) {
+                                f(i, j);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    std::size_t bucket(const std::int64_t x, const std::int64_t y, const std::int64_t z)
+        const {
+        const std::uint64_t h = (static_cast<std::uint64_t>(x) * 73856093U)
+            ^ (static_cast<std::uint64_t>(y) * 19349663U)
+            ^ (static_cast<std::uint64_t>(z) * 83492791U);
+        return static_cast<std::size_t>(h ^ (h >> 32)) & mask_;
+    }
+
+    std::size_t mask_ = 0;
+    std::vector<std::int64_t> cx_, cy_, cz_;
+    std::vector<std::size_t> bucket_of_, start_, next_, order_;
+};
+
+/// Screens one time step at a time, reusing its buffers between steps
+class StepScreener {
+public:
+    StepScreener(
+        const SatelliteCatalog &catalog, const std::vector<Shell> &shells,
+        const JulianDate start, const double span_secs, const double threshold,
+        const double step_secs
+    )
+        : catalog_(catalog), shells_(shells), start_(start), span_secs_(span_secs),
+          threshold_(threshold), half_step_(step_secs / 2.0),
+          sv_(catalog.size()), err_(catalog.size()) {
+        // Bound on how far the relative motion strays from a straight line over
+        // half a step, per [km] of separation, from the gravity gradient
+        tidal_ = std::cosh(tidal_rate() * half_step_) - 1.0;
+    }
+
+    /// Screen the step at `t` seconds from the start, appending conjunctions
+    /// to `out`, and return the number of propagation errors
+    std::size_t screen(const double t, std::vector<Conjunction> &out) {
+        const JulianDate jd = start_ + t / SECS_PER_DAY;
+        const std::size_t n_errors =
+            catalog_.propagate_grid(0, catalog_.size(), &jd, 1, sv_.data(), err_.data());
+        idx_.clear();
+        pos_.clear();
+        vel_.clear();
+        double max_speed_sq = 0.0;
+        for (std::size_t i = 0; i < catalog_.size(); ++i) {
+            if (err_[i] == Sgp4Error::NONE) {
+                idx_.push_back(i);
+                pos_.push_back(sv_[i].position);
+                vel_.push_back(sv_[i].velocity);
+                const double speed_sq = dot(sv_[i].velocity, sv_[i].velocity);
+                max_speed_sq = std::max(max_speed_sq, speed_sq);
+            }
+        }
+        // Any pair that gets within the threshold during the step is at most this
+        // far apart now, so is in the same or an adjacent cell
+        const double reach = threshold_ + CANDIDATE_MARGIN
+            + 2.0 * std::sqrt(max_speed_sq) * half_step_;
+        hash_.build(pos_, reach / (1.0 - 2.0 * tidal_));
+
+        const double lo = std::max(-half_step_, -t);
+        const double hi = std::min(half_step_, span_secs_ - t);
+        hash_.for_each_pair([&](const std::size_t i, const std::size_t j) {
+            const std::size_t a = idx_[i], b = idx_[j];
+            const Shell &sa = shells_[a], &sb = shells_[b];
+            const double shell_gap =
+                std::max(sa.perigee, sb.perigee) - std::min(sa.apogee, sb.apogee);
+            if (shell_gap > threshold_ + SHELL_MARGIN) {
+                return;
+            }
+            const Vec3 dr = sub(pos_[j], pos_[i]);
+            const Vec3 dv = sub(vel_[j], vel_[i]);
+            const double dv_sq = dot(dv, dv);
+            const double tau =
+                (dv_sq > 0.0) ? std::min(hi, std::max(lo, -dot(dr, dv) / dv_sq)) : 0.0;
+            const Vec3 closest { { dr[0] + dv[0] * tau, dr[1] + dv[1] * tau,
+                                   dr[2] + dv[2] * tau } };
+            const double dist = std::sqrt(dot(dr, dr));
+            const double speed = std::sqrt(dv_sq);
+            const double limit = threshold_ + CANDIDATE_MARGIN
+                + tidal_ * (dist + speed * half_step_);
+            if (dot(closest, closest) <= limit * limit) {
+                Conjunction conj;
+                if (refine(a, b, t + tau, conj) && conj.miss_distance <= threshold_) {
+                    out.push_back(conj);
+                }
+            }
+        });
+        return n_errors;
+    }
+
+private:
+    /// Propagate a pair and return their relative position and velocity
+    bool relative_state(
+        const std::size_t a, const std::size_t b, const double t, Vec3 &dr, Vec3 &dv
+    ) const {
+        const JulianDate jd = start_ + t / SECS_PER_DAY;
+        StateVector sv_a, sv_b;
+        if (catalog_[a].propagate(jd, sv_a) != Sgp4Error::NONE
+            || catalog_[b].propagate(jd, sv_b) != Sgp4Error::NONE) {
+            return false;
+        }
+        dr = sub(sv_b.position, sv_a.position);
+        dv = sub(sv_b.velocity, sv_a.velocity);
+        return true;
+    }
+
+    /// Newton's method on the range rate, starting at `t` seconds from the start.
+    ///
+    /// The derivative of `dr . dv` is `|dv|^2` plus the relative acceleration
+    /// term, which is tiny for a close pair, so each step is just the straight
+    /// line time of closest approach. Steps are limited to a whole time step in
+    /// case the pair is slow enough for the acceleration to matter, and the
+    /// closest point that was propagated is kept.
+    bool refine(const std::size_t a, const std::size_t b, double t, Conjunction &out)
+        const {
+        out.sat_a = a;
+        out.sat_b = b;
+        double best_t = t;
+        for (int iter = 0; iter < MAX_TCA_ITERATIONS; ++iter) {
+            Vec3 dr, dv;
+            if (!relative_state(a, b, t, dr, dv)) {
+                return false;
+            }
+            const double range = std::sqrt(dot(dr, dr));
+            if (iter == 0 || range < out.miss_distance) {
+                best_t = t;
+                out.miss_distance = range;
+                out.relative_speed = std::sqrt(dot(dv, dv));
+            }
+            const double dv_sq = dot(dv, dv);
+            if (dv_sq == 0.0) {
+                break;
+            }
+            const double max_jump = 2.0 * half_step_;
+            const double jump =
+                std::min(max_jump, std::max(-max_jump, -dot(dr, dv) / dv_sq));
+            const double next = std::min(span_secs_, std::max(0.0, t + jump));
+            if (std::fabs(next - t) <= TCA_TIME_TOLERANCE) {
+                break;
+            }
+            t = next;
+        }
+        out.tca = start_ + best_t / SECS_PER_DAY;
+        return true;
+    }
+
+    const SatelliteCatalog &catalog_;
+    const std::vector<Shell> &shells_;
+    JulianDate start_;
+    double span_secs_, threshold_, half_step_, tidal_;
+    std::vector<StateVector> sv_;
+    std::vector<Sgp4Error> err_;
+    // Satellites that propagated at the current step, and their state
+    std::vector<std::size_t> idx_;
+    std::vector<Vec3> pos_, vel_;
+    SpatialHash hash_;
+};
+
+bool pair_time_less(const Conjunction &x, const Conjunction &y) {
+    if (x.sat_a != y.sat_a) {
+        return x.sat_a < y.sat_a;
+    }
+    if (x.sat_b != y.sat_b) {
+        return x.sat_b < y.sat_b;
+    }
+    return x.tca < y.tca;
+}
+
+bool time_pair_less(const Conjunction &x, const Conjunction &y) {
+    if (x.tca < y.tca || y.tca < x.tca) {
+        return x.tca < y.tca;
+    }
+    if (x.sat_a != y.sat_a) {
+        return x.sat_a < y.sat_a;
+    }
+    return x.sat_b < y.sat_b;
+}
+
+}  // namespace
+
+std::size_t screen_conjunctions(
+    const SatelliteCatalog &catalog, const JulianDate start, const JulianDate end,
+    const double threshold, std::vector<Conjunction> &out, const double step_secs,
+    const std::size_t n_threads
+) {
+    if (catalog.size() == 0 || end < start) {
+        return 0;
+    }
+    std::vector<Shell> shells(catalog.size());
+    for (std::size_t i = 0; i < catalog.size(); ++i) {
+        shells[i] = shell_of(catalog[i]);
+    }
+    // Longer steps are split up, as the straight-line bound stops holding
+    const double max_step = 2.0 * std::acosh(1.0 + MAX_TIDAL) / tidal_rate();
+    const double step = std::min(step_secs, max_step);
+    // Steps are evenly spaced, except the last one which lands on the end
+    const double span_secs = (end - start) * SECS_PER_DAY;
+    const auto n_steps = static_cast<std::size_t>(std::ceil(span_secs / step)) + 1;
+    const std::size_t n_blocks = (n_steps + STEPS_PER_BLOCK - 1) / STEPS_PER_BLOCK;
+
+    std::vector<std::vector<Conjunction>> found(n_blocks);
+    std::vector<std::size_t> n_errors(n_blocks, 0);
+    parallel_for_blocks(
+        n_steps, STEPS_PER_BLOCK, n_threads,
+        [&](const std::size_t begin, const std::size_t block_end) {
+            const std::size_t block = begin / STEPS_PER_BLOCK;
+            StepScreener screener(
+                catalog, shells, start, span_secs, threshold, step
+            );
+            for (std::size_t k = begin; k < block_end; ++k) {
+                const double t = std::min(static_cast<double>(k) * step, span_secs);
+                n_errors[block] += screener.screen(t, found[block]);
+            }
+        }
+    );
+
+    // Candidates from consecutive steps usually refine to the same encounter
+    std::vector<Conjunction> all;
+    std::size_t n_failed = 0;
+    for (std::size_t block = 0; block < n_blocks; ++block) {
+        all.insert(all.end(), found[block].begin(), found[block].end());
+        n_failed += n_errors[block];
+    }
+    std::sort(all.begin(), all.end(), pair_time_less);
+    const double same_encounter = 2.0 * step / SECS_PER_DAY;
+    std::vector<Conjunction> unique;
+    for (const Conjunction &conj : all) {
+        if (!unique.empty() && unique.back().sat_a == conj.sat_a
+            && unique.back().sat_b == conj.sat_b
+            && conj.tca - unique.back().tca <= same_encounter) {
+            if (conj.miss_distance < unique.back().miss_distance) {
+                unique.back() = conj;
+            }
+            continue;
+        }
+        unique.push_back(conj);
+    }
+    std::sort(unique.begin(), unique.end(), time_pair_less);
+    out.insert(out.end(), unique.begin(), unique.end());
+    return n_failed;
+}
+
+}  // namespace perturb
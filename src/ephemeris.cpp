@@ -0,0 +1,235 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#include "perturb/ephemeris.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "common.hpp"
+#include "perturb/sgp4.hpp"
+
+namespace perturb {
+
+namespace {
+
+constexpr std::size_t N = EPHEMERIS_DEGREE;
+constexpr double DEGREE = static_cast<double>(N);
+
+/// Length of the first segment, as a fraction of the orbit period
+constexpr double FIRST_SEGMENT_PER_PERIOD = 1.0 / 8.0;
+
+/// Longest segment, as a fraction of the orbit period
+constexpr double MAX_SEGMENT_PER_PERIOD = 1.0 / 2.0;
+
+/// Most a segment can grow from one to the next
+constexpr double MAX_SEGMENT_GROWTH = 2.0;
+
+/// Fraction of the error bound the checks within a segment have to be within,
+/// since the error can peak a bit away from them
+constexpr double CHECK_ERROR_FRACTION = 0.5;
+
+using Series = double[N + 1][3];
+
+double distance(const Vec3 &a, const Vec3 &b) {
+    const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/// Evaluate the Chebyshev series of each axis at `x` with Clenshaw's recurrence
+Vec3 evaluate(const Series &a, const double x) {
+    Vec3 out;
+    for (std::size_t k = 0; k < 3; ++k) {
+        double b1 = 0.0, b2 = 0.0;
+        for (std::size_t j = N; j > 0; --j) {
+            const double b0 = a[j][k] + 2.0 * x * b1 - b2;
+            b2 = b1;
+            b1 = b0;
+        }
+        out[k] = a[0][k] + x * b1 - b2;
+    }
+    return out;
+}
+
+/// Fit the series through samples at the Chebyshev extrema `x_j = cos(pi j / N)`,
+/// which is a type I discrete cosine transform
+void fit(const Vec3 (&f)[N + 1], const double (&cos_jk)[N + 1][N + 1], Series &a) {
+    for (std::size_t k = 0; k <= N; ++k) {
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            double sum = 0.5 * (f[0][axis] + cos_jk[N][k] * f[N][axis]);
+            for (std::size_t j = 1; j < N; ++j) {
+                sum += cos_jk[j][k] * f[j][axis];
+            }
+            const double scale = (k == 0 || k == N) ? 1.0 / DEGREE : 2.0 / DEGREE;
+            a[k][axis] = scale * sum;
+        }
+    }
+}
+
+}  // namespace
+
+Ephemeris::Ephemeris(
+    const Satellite &sat, const JulianDate start, const JulianDate end,
+    const double max_error
+)
+    : sat_(sat), last_error_(Sgp4Error::NONE), start_(start) {
+    const double span = std::max(0.0, (end - start) * SECS_PER_DAY);
+    const double mean_motion = sat.sat_rec.no_kozai / SECS_PER_MIN;  // [rad/s]
+    const double period = 2.0 * PI / mean_motion;
+    const double max_segment =
+        std::max(EPHEMERIS_MIN_SEGMENT, MAX_SEGMENT_PER_PERIOD * period);
+    const double pos_tolerance = CHECK_ERROR_FRACTION * max_error;
+    const double vel_tolerance = pos_tolerance * mean_motion;
+
+    double cos_jk[N + 1][N + 1];
+    for (std::size_t j = 0; j <= N; ++j) {
+        for (std::size_t k = 0; k <= N; ++k) {
+            cos_jk[j][k] = std::cos(PI * static_cast<double>(j * k) / DEGREE);
+        }
+    }
+    // Checks halfway (in angle) between each pair of samples, in [-1, 1]
+    double check_x[N];
+    for (std::size_t j = 0; j < N; ++j) {
+        check_x[j] = std::cos(PI * (static_cast<double>(j) + 0.5) / DEGREE);
+    }
+
+    sgp4::elsetrec_state state {};
+    const auto sample = [&](const double t, StateVector &sv) {
+        return sat_.propagate(start_ + t / SECS_PER_DAY, sv, state);
+    };
+    StateVector sv0;
+    last_error_ = sample(0.0, sv0);
+    if (last_error_ != Sgp4Error::NONE) {
+        return;
+    }
+    nodes_.push_back(0.0);
+    double t = 0.0;
+    double h = std::max(EPHEMERIS_MIN_SEGMENT, FIRST_SEGMENT_PER_PERIOD * period);
+    while (t < span) {
+        h = std::min(h, span - t);
+        const bool shortest = h <= EPHEMERIS_MIN_SEGMENT;
+        const auto time_at = [&](const double x) {
+            return t + 0.5 * h * (1.0 + x);
+        };
+        // Sample in order of time, which keeps deep-space resonance integration
+        // going forwards. Sample `j` is at `x_j`, from the end back to the start,
+        // and check `j` is halfway between samples `j` and `j + 1`.
+        Vec3 pos[N + 1], vel[N + 1];
+        pos[N] = sv0.position;
+        vel[N] = sv0.velocity;
+        StateVector checks[N], sv;
+        Sgp4Error err = Sgp4Error::NONE;
+        for (std::size_t j = N; j-- > 0 && err == Sgp4Error::NONE;) {
+            err = sample(time_at(check_x[j]), checks[j]);
+            if (err == Sgp4Error::NONE) {
+                err = sample(time_at(cos_jk[j][1]), sv);
+                pos[j] = sv.position;
+                vel[j] = sv.velocity;
+            }
+        }
+        if (err != Sgp4Error::NONE) {
+            // Home in on where the error starts, then stop there
+            if (shortest) {
+                last_error_ = err;
+                return;
+            }
+            h = std::max(EPHEMERIS_MIN_SEGMENT, h / 2.0);
+            continue;
+        }
+
+        Segment seg;
+        fit(pos, cos_jk, seg.position);
+        fit(vel, cos_jk, seg.velocity);
+        double pos_error = 0.0, vel_error = 0.0;
+        for (std::size_t j = 0; j < N; ++j) {
+            const Vec3 p = evaluate(seg.position, check_x[j]);
+            const Vec3 v = evaluate(seg.velocity, check_x[j]);
+            pos_error = std::max(pos_error, distance(p, checks[j].position));
+            vel_error = std::max(vel_error, distance(v, checks[j].velocity));
+        }
+        const double ratio =
+            std::max(pos_error / pos_tolerance, vel_error / vel_tolerance);
+        // The error scales with the length to the power of the degree plus one
+        const double scale = (ratio > 0.0)
+            ? 0.9 * std::pow(ratio, -1.0 / (DEGREE + 1.0))
+            : MAX_SEGMENT_GROWTH;
+        if (ratio > 1.0) {
+            // Somewhere SGP4 isn't smooth enough to fit, so leave the rest to it
+            if (shortest) {
+                return;
+            }
+            h = std::max(EPHEMERIS_MIN_SEGMENT, h * std::max(0.25, scale));
+            continue;
+        }
+        segments_.push_back(seg);
+        t = (h == span - t) ? span : t + h;
+        nodes_.push_back(t);
+        sv0 = sv;
+        h = std::max(EPHEMERIS_MIN_SEGMENT, h * std::min(MAX_SEGMENT_GROWTH, scale));
+        h = std::min(max_segment, h);
+    }
+}
+
+const Satellite &Ephemeris::satellite() const {
+    return sat_;
+}
+
+Sgp4Error Ephemeris::last_error() const {
+    return last_error_;
+}
+
+JulianDate Ephemeris::start() const {
+    return start_;
+}
+
+JulianDate Ephemeris::end() const {
+    return start_ + (nodes_.empty() ? 0.0 : nodes_.back()) / SECS_PER_DAY;
+}
+
+std::size_t Ephemeris::size() const {
+    return segments_.size();
+}
+
+Sgp4Error Ephemeris::propagate_from_epoch(
+    const double mins_from_epoch, StateVector &sv
+) const {
+    const double t = (sat_.epoch() - start_) * SECS_PER_DAY
+        + mins_from_epoch * SECS_PER_MIN;
+    if (segments_.empty() || t < 0.0 || t > nodes_.back()) {
+        return sat_.propagate_from_epoch(mins_from_epoch, sv);
+    }
+    StateVector out;
+    const Sgp4Error err = propagate(start_ + t / SECS_PER_DAY, out);
+    out.epoch = sat_.epoch() + mins_from_epoch / MINS_PER_DAY;
+    sv = out;
+    return err;
+}
+
+Sgp4Error Ephemeris::propagate(const JulianDate jd, StateVector &sv) const {
+    const double t = (jd - start_) * SECS_PER_DAY;
+    if (segments_.empty() || t < 0.0 || t > nodes_.back()) {
+        return sat_.propagate(jd, sv);
+    }
+    // Segment `i` spans nodes `i` and `i + 1`, and the last node closes the last one
+    const auto upper = std::upper_bound(nodes_.begin(), nodes_.end(), t);
+    const auto i = std::min(
+        static_cast<std::size_t>(upper - nodes_.begin()) - 1, segments_.size() - 1
+    );
+    const double x = 2.0 * (t - nodes_[i]) / (nodes_[i + 1] - nodes_[i]) - 1.0;
+    sv.epoch = jd;
+    sv.position = evaluate(segments_[i].position, x);
+    sv.velocity = evaluate(segments_[i].velocity, x);
+    return Sgp4Error::NONE;
+}
+
+}  // namespace perturb
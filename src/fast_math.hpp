@@ -0,0 +1,57 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+// Private trigonometry of the propagation hot path, not installed
+
+#ifndef PERTURB_SRC_FAST_MATH_HPP
+#define PERTURB_SRC_FAST_MATH_HPP
+
+#include <cmath>
+#include <cstdint>
+
+#include "kepler.hpp"
+
+namespace perturb {
+
+/// Sine and cosine of the same angle.
+///
+/// With `PERTURB_ENABLE_FAST_MATH`, fused into one `lane_sincos`, which shares
+/// the range reduction and inlines. Otherwise the math library's, so results
+/// stay bit-identical to the reference implementation.
+template <typename Real>
+inline void hot_sincos(const Real x, Real &out_sin, Real &out_cos) {
+#ifdef PERTURB_ENABLE_FAST_MATH
+    lane_sincos(x, out_sin, out_cos);
+#else
+    out_sin = std::sin(x);
+    out_cos = std::cos(x);
+#endif
+}
+
+/// Same as `std::fmod(x, twopi)`.
+///
+/// With `PERTURB_ENABLE_FAST_MATH`, subtracts the truncated multiple of
+/// `twopi` instead, which is a division and a multiply-add rather than the
+/// exact remainder loop of `fmod`. That's off by up to about an ulp of `x`,
+/// which is already the rounding error of the angle being reduced.
+inline double hot_fmod(const double x, const double twopi) {
+#ifdef PERTURB_ENABLE_FAST_MATH
+    // SGP4 angles stay well within the range of a 64-bit integer
+    const auto n = static_cast<double>(static_cast<std::int64_t>(x / twopi));
+    return x - n * twopi;
+#else
+    return std::fmod(x, twopi);
+#endif
+}
+
+}  // namespace perturb
+
+#endif  // PERTURB_SRC_FAST_MATH_HPP
@@ -0,0 +1,394 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#include "perturb/frames.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#ifndef PERTURB_DISABLE_IO
+#  include <cstdlib>
+#  include <cstring>
+#endif
+
+#include "common.hpp"
+#ifndef PERTURB_DISABLE_IO
+#  include "mapped_file.hpp"
+#endif
+#include "perturb/sgp4.hpp"
+
+namespace perturb {
+
+namespace {
+
+/// Julian date of the Modified Julian date epoch
+constexpr double MJD_EPOCH = 2400000.5;
+
+/// Square of the first eccentricity of the WGS84 ellipsoid
+constexpr double WGS84_E2 = WGS84_FLATTENING * (2.0 - WGS84_FLATTENING);
+
+double to_mjd(const JulianDate jd) {
+    return (jd.jd - MJD_EPOCH) + jd.jd_frac;
+}
+
+bool same_time(const JulianDate &a, const JulianDate &b) {
+    return a.jd == b.jd && a.jd_frac == b.jd_frac;
+}
+
+EarthOrientation lookup(const EopTable *eop, const JulianDate jd) {
+    return eop ? eop->at(jd) : EarthOrientation {};
+}
+
+/// Rate of change of `sgp4::gstime_SGP4` in [rad/day], its derivative
+double gmst_rate(const double jd_ut1) {
+    constexpr double DAYS_PER_CENTURY = 36525.0;
+    const double tut1 = (jd_ut1 - 2451545.0) / DAYS_PER_CENTURY;
+    // Derivative of Vallado eq 3-45 in [s] per century, then [rad/day]
+    const double dtemp = -3.0 * 6.2e-6 * tut1 * tut1 + 2.0 * 0.093104 * tut1
+        + (876600.0 * 3600 + 8640184.812866);
+    return dtemp * (PI / 43200.0) / DAYS_PER_CENTURY;
+}
+
+#ifndef PERTURB_DISABLE_IO
+/// Parse the fixed-width number in columns `[begin, end)` of a line
+bool parse_column(
+    const char *line, const std::size_t begin, const std::size_t end, double &out
+) {
+    char buf[16] = {};
+    std::memcpy(buf, line + begin, end - begin);
+    char *num_end = nullptr;
+    out = std::strtod(buf, &num_end);
+    if (num_end == buf) {
+        return false;  // Blank or not a number
+    }
+    while (*num_end == ' ') {
+        ++num_end;
+    }
+    return *num_end == '\0';
+}
+#endif  // PERTURB_DISABLE_IO
+
+}  // namespace
+
+EarthRotation::EarthRotation(const JulianDate jd, const EarthOrientation &eop)
+    : epoch_(jd) {
+    const double jd_ut1 = jd.jd + (jd.jd_frac + eop.ut1_utc / SECS_PER_DAY);
+    gmst_ = sgp4::gstime_SGP4(jd_ut1);
+    cos_gmst_ = std::cos(gmst_);
+    sin_gmst_ = std::sin(gmst_);
+    cos_xp_ = std::cos(eop.xp);
+    sin_xp_ = std::sin(eop.xp);
+    cos_yp_ = std::cos(eop.yp);
+    sin_yp_ = std::sin(eop.yp);
+}
+
+JulianDate EarthRotation::epoch() const {
+    return epoch_;
+}
+
+double EarthRotation::gmst() const {
+    return gmst_;
+}
+
+Vec3 EarthRotation::rotate(const Vec3 &teme) const {
+    // TEME to PEF, a rotation about z by GMST
+    const double x = cos_gmst_ * teme[0] + sin_gmst_ * teme[1];
+    const double y = cos_gmst_ * teme[1] - sin_gmst_ * teme[0];
+    const double z = teme[2];
+    // PEF to ECEF, the transpose of the polar motion matrix (Vallado eq 3-77)
+    return Vec3 { {
+        cos_xp_ * x + sin_xp_ * (sin_yp_ * y + cos_yp_ * z),
+        cos_yp_ * y - sin_yp_ * z,
+        -sin_xp_ * x + cos_xp_ * (sin_yp_ * y + cos_yp_ * z),
+    } };
+}
+
+EcefState EarthRotation::to_ecef(const StateVector &sv) const {
+    EcefState out;
+    out.epoch = sv.epoch;
+    // The velocity gets the rotation of the frame removed in PEF, before the
+    // polar motion, since the Earth spins about the PEF z axis
+    const double px = cos_gmst_ * sv.position[0] + sin_gmst_ * sv.position[1];
+    const double py = cos_gmst_ * sv.position[1] - sin_gmst_ * sv.position[0];
+    const double pz = sv.position[2];
+    const double vx = cos_gmst_ * sv.velocity[0] + sin_gmst_ * sv.velocity[1]
+        + EARTH_ROTATION_RATE * py;
+    const double vy = cos_gmst_ * sv.velocity[1] - sin_gmst_ * sv.velocity[0]
+        - EARTH_ROTATION_RATE * px;
+    const double vz = sv.velocity[2];
+
+    const double p_yz = sin_yp_ * py + cos_yp_ * pz;
+    out.position[0] = cos_xp_ * px + sin_xp_ * p_yz;
+    out.position[1] = cos_yp_ * py - sin_yp_ * pz;
+    out.position[2] = -sin_xp_ * px + cos_xp_ * p_yz;
+    const double v_yz = sin_yp_ * vy + cos_yp_ * vz;
+    out.velocity[0] = cos_xp_ * vx + sin_xp_ * v_yz;
+    out.velocity[1] = cos_yp_ * vy - sin_yp_ * vz;
+    out.velocity[2] = -sin_xp_ * vx + cos_xp_ * v_yz;
+    return out;
+}
+
+EarthRotationCache::EarthRotationCache(const EopTable *eop)
+    : eop_(eop),
+      valid_(false),
+      n_evaluations_(0),
+      step_days_(0.0),
+      cos_step_(1.0),
+      sin_step_(0.0),
+      gmst_step_(0.0),
+      n_steps_(0) {}
+
+const EarthRotation &EarthRotationCache::at(const JulianDate jd) {
+    if (!valid_ || !same_time(jd, rot_.epoch_)) {
+        evaluate(jd);
+    }
+    return rot_;
+}
+
+const EarthRotation &EarthRotationCache::begin_steps(
+    const JulianDate start, const double step
+) {
+    start_ = start;
+    step_days_ = step / SECS_PER_DAY;
+    n_steps_ = 0;
+    evaluate(start);
+    set_step(start);
+    return rot_;
+}
+
+const EarthRotation &EarthRotationCache::next_step() {
+    const JulianDate last = start_ + static_cast<double>(n_steps_) * step_days_;
+    ++n_steps_;
+    const JulianDate jd = start_ + static_cast<double>(n_steps_) * step_days_;
+    // Start over if due, on a new row of the EOP table, or if `at` moved the
+    // cache off the grid in between
+    if (n_steps_ % EARTH_ROTATION_RESYNC_STEPS == 0
+        || std::floor(to_mjd(jd)) != std::floor(to_mjd(last)) || !valid_
+        || !same_time(last, rot_.epoch_)) {
+        evaluate(jd);
+        set_step(jd);
+        return rot_;
+    }
+    const double c = rot_.cos_gmst_, s = rot_.sin_gmst_;
+    rot_.cos_gmst_ = c * cos_step_ - s * sin_step_;
+    rot_.sin_gmst_ = s * cos_step_ + c * sin_step_;
+    double gmst = rot_.gmst_ + gmst_step_;
+    if (gmst >= 2.0 * PI) {
+        gmst -= 2.0 * PI;
+    } else if (gmst < 0.0) {
+        gmst += 2.0 * PI;
+    }
+    rot_.gmst_ = gmst;
+    rot_.epoch_ = jd;
+    return rot_;
+}
+
+std::size_t EarthRotationCache::n_evaluations() const {
+    return n_evaluations_;
+}
+
+void EarthRotationCache::evaluate(const JulianDate jd) {
+    rot_ = EarthRotation(jd, lookup(eop_, jd));
+    valid_ = true;
+    ++n_evaluations_;
+}
+
+void EarthRotationCache::set_step(const JulianDate jd) {
+    // UT1 - UTC drifts by a millisecond or two a day, which adds up over a
+    // long grid, so step with its rate too (unless a leap second is in the way)
+    double step_ut1 = step_days_;
+    if (eop_) {
+        const double d_ut1 = eop_->at(jd + step_days_).ut1_utc - eop_->at(jd).ut1_utc;
+        if (std::fabs(d_ut1) < 0.5) {
+            step_ut1 += d_ut1 / SECS_PER_DAY;
+        }
+    }
+    // The rate of GMST barely changes between resyncs, and using UTC for UT1
+    // makes no difference to it
+    gmst_step_ = gmst_rate(jd.jd + jd.jd_frac) * step_ut1;
+    cos_step_ = std::cos(gmst_step_);
+    sin_step_ = std::sin(gmst_step_);
+}
+
+EopTable::EopTable() = default;
+
+#ifndef PERTURB_DISABLE_IO
+bool EopTable::load(const char *path) {
+    // Columns of the IERS Bulletin A values, from `readme.finals2000A`
+    constexpr std::size_t MJD_BEGIN = 7, MJD_END = 15;
+    constexpr std::size_t XP_BEGIN = 18, XP_END = 27;
+    constexpr std::size_t YP_BEGIN = 37, YP_END = 46;
+    constexpr std::size_t UT1_BEGIN = 58, UT1_END = 68;
+    constexpr double RAD_PER_ARCSEC = PI / (180.0 * 3600.0);
+
+    const MappedFile file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::size_t size_before = size();
+    const char *pos = file.data();
+    const char *const end = file.data() + file.size();
+    while (pos < end) {
+        const char *line = pos;
+        const auto remaining = static_cast<std::size_t>(end - pos);
+        const void *newline = std::memchr(pos, '\n', remaining);
+        const char *line_end = newline ? static_cast<const char *>(newline) : end;
+        pos = line_end + 1;
+        if (static_cast<std::size_t>(line_end - line) < UT1_END) {
+            continue;
+        }
+        double mjd, xp, yp, ut1_utc;
+        if (parse_column(line, MJD_BEGIN, MJD_END, mjd)
+            && parse_column(line, XP_BEGIN, XP_END, xp)
+            && parse_column(line, YP_BEGIN, YP_END, yp)
+            && parse_column(line, UT1_BEGIN, UT1_END, ut1_utc)) {
+            const EarthOrientation eop {
+                xp * RAD_PER_ARCSEC, yp * RAD_PER_ARCSEC, ut1_utc
+            };
+            add(mjd, eop);
+        }
+    }
+    return size() > size_before;
+}
+#endif  // PERTURB_DISABLE_IO
+
+void EopTable::add(const double mjd, const EarthOrientation &eop) {
+    mjd_.push_back(mjd);
+    eop_.push_back(eop);
+}
+
+std::size_t EopTable::size() const {
+    return mjd_.size();
+}
+
+EarthOrientation EopTable::at(const JulianDate jd) const {
+    if (mjd_.empty()) {
+        return EarthOrientation {};
+    }
+    const double mjd = to_mjd(jd);
+    const auto upper = std::upper_bound(mjd_.begin(), mjd_.end(), mjd);
+    if (upper == mjd_.begin()) {
+        return eop_.front();
+    }
+    if (upper == mjd_.end()) {
+        return eop_.back();
+    }
+    const auto i = static_cast<std::size_t>(upper - mjd_.begin()) - 1;
+    const EarthOrientation &a = eop_[i];
+    const EarthOrientation &b = eop_[i + 1];
+    const double t = (mjd - mjd_[i]) / (mjd_[i + 1] - mjd_[i]);
+    // A leap second makes UT1 - UTC jump by a whole second at the end of the
+    // day, so interpolate towards where it would be without the jump
+    double d_ut1 = b.ut1_utc - a.ut1_utc;
+    if (d_ut1 > 0.5) {
+        d_ut1 -= 1.0;
+    } else if (d_ut1 < -0.5) {
+        d_ut1 += 1.0;
+    }
+    return EarthOrientation {
+        a.xp + t * (b.xp - a.xp),
+        a.yp + t * (b.yp - a.yp),
+        a.ut1_utc + t * d_ut1,
+    };
+}
+
+EcefState to_ecef(const StateVector &sv, const EarthOrientation &eop) {
+    return EarthRotation(sv.epoch, eop).to_ecef(sv);
+}
+
+void to_ecef(
+    const StateVector *sv, const std::size_t n, EcefState *out, const EopTable *eop
+) {
+    EarthRotationCache cache(eop);
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = cache.at(sv[i].epoch).to_ecef(sv[i]);
+    }
+}
+
+Geodetic to_geodetic(const Vec3 &position) {
+    // Olson (1996), with the constants scaled to the ellipsoid in [km]
+    constexpr double a = WGS84_RADIUS;
+    constexpr double e2 = WGS84_E2;
+    constexpr double a1 = a * e2;
+    constexpr double a2 = a1 * a1;
+    constexpr double a3 = a1 * e2 / 2;
+    constexpr double a4 = 2.5 * a2;
+    constexpr double a5 = a1 + a3;
+    constexpr double a6 = 1 - e2;
+
+    const double x = position[0], y = position[1], z = position[2];
+    const double zp = std::fabs(z);
+    const double w2 = x * x + y * y;
+    const double w = std::sqrt(w2);
+    const double r2 = w2 + z * z;
+    const double r = std::sqrt(r2);
+
+    Geodetic geo;
+    geo.longitude = std::atan2(y, x);
+    const double s2 = z * z / r2;
+    const double c2 = w2 / r2;
+    double u = a2 / r;
+    double v = a3 - a4 / r;
+    double s, c, ss, lat;
+    // Starting guess, picking whichever of sin or cos is better conditioned
+    if (c2 > 0.3) {
+        s = (zp / r) * (1 + c2 * (a1 + u + s2 * v) / r);
+        lat = std::asin(s);
+        ss = s * s;
+        c = std::sqrt(1 - ss);
+    } else {
+        c = (w / r) * (1 - s2 * (a5 - u - c2 * v) / r);
+        lat = std::acos(c);
+        ss = 1 - c * c;
+        s = std::sqrt(ss);
+    }
+    // One correction step, which is enough for full precision
+    const double g = 1 - e2 * ss;
+    const double rg = a / std::sqrt(g);
+    const double rf = a6 * rg;
+    u = w - rg * c;
+    v = zp - rf * s;
+    const double f = c * u + s * v;
+    const double m = c * v - s * u;
+    const double p = m / (rf / g + f);
+    lat += p;
+    geo.altitude = f + m * p / 2;
+    geo.latitude = (z < 0) ? -lat : lat;
+    return geo;
+}
+
+Geodetic to_geodetic(const StateVector &sv, const EarthOrientation &eop) {
+    return to_geodetic(EarthRotation(sv.epoch, eop).rotate(sv.position));
+}
+
+void to_geodetic(
+    const StateVector *sv, const std::size_t n, Geodetic *out, const EopTable *eop
+) {
+    EarthRotationCache cache(eop);
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = to_geodetic(cache.at(sv[i].epoch).rotate(sv[i].position));
+    }
+}
+
+Vec3 to_ecef(const Geodetic &geo) {
+    const double sin_lat = std::sin(geo.latitude);
+    const double cos_lat = std::cos(geo.latitude);
+    // Radius of curvature in the prime vertical
+    const double n = WGS84_RADIUS / std::sqrt(1 - WGS84_E2 * sin_lat * sin_lat);
+    const double w = (n + geo.altitude) * cos_lat;
+    return Vec3 { {
+        w * std::cos(geo.longitude),
+        w * std::sin(geo.longitude),
+        (n * (1 - WGS84_E2) + geo.altitude) * sin_lat,
+    } };
+}
+
+}  // namespace perturb
@@ -0,0 +1,193 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+// Private batched Kepler solver of the catalog kernels, not installed
+
+#ifndef PERTURB_SRC_KEPLER_HPP
+#define PERTURB_SRC_KEPLER_HPP
+
+#include <cmath>
+#include <cstddef>
+
+namespace perturb {
+
+/// Constants of `lane_sincos` and `solve_kepler` for each precision
+template <typename Real>
+struct KeplerTraits;
+
+// Polynomials on [-pi/4, pi/4] from fdlibm's `__kernel_sin` and `__kernel_cos`
+template <>
+struct KeplerTraits<double> {
+    static constexpr double TWO_OVER_PI = 6.36619772367581382433e-01;
+    // pi/2 split so that `q * PIO2_1` and `q * PIO2_2` are exact for |q| < 2^20
+    static constexpr double PIO2_1 = 1.57079632673412561417e+00;
+    static constexpr double PIO2_2 = 6.07710050630396597660e-11;
+    static constexpr double PIO2_3 = 2.02226624879595063154e-21;
+
+    static double sin_poly(const double z) {
+        return -1.66666666666666324348e-01
+            + z * (8.33333333332248946124e-03
+                   + z * (-1.98412698298579493134e-04
+                          + z * (2.75573137070700676789e-06
+                                 + z * (-2.50507602534068634195e-08
+                                        + z * 1.58969099521155010221e-10))));
+    }
+    static double cos_poly(const double z) {
+        return 4.16666666666666019037e-02
+            + z * (-1.38888888888741095749e-03
+                   + z * (2.48015872894767294178e-05
+                          + z * (-2.75573143513906633035e-07
+                                 + z * (2.08757232129817482790e-09
+                                        + z * -1.13596475577881948265e-11))));
+    }
+
+    static constexpr double TOLERANCE = 1.0e-12;
+    // Halley's error is cubic in the step, so stop once that's well under tolerance
+    static constexpr double CUBIC_TOLERANCE = 1.0e-15;
+};
+
+// Polynomials from Cephes' `sinf` and `cosf`. Single precision can't converge
+// to 1e-12, but the rounding error of a float near 2pi is already about 5e-7,
+// so there's nothing to gain past this.
+template <>
+struct KeplerTraits<float> {
+    static constexpr float TWO_OVER_PI = 0.636619772F;
+    static constexpr float PIO2_1 = 1.5703125F;
+    static constexpr float PIO2_2 = 4.837512969970703125e-4F;
+    static constexpr float PIO2_3 = 7.54978995489188216e-8F;
+
+    static float sin_poly(const float z) {
+        return -1.6666654611e-1F + z * (8.3321608736e-3F + z * -1.9515295891e-4F);
+    }
+    static float cos_poly(const float z) {
+        return 4.166664568298827e-2F
+            + z * (-1.388731625493765e-3F + z * 2.443315711809948e-5F);
+    }
+
+    static constexpr float TOLERANCE = 1.0e-6F;
+    static constexpr float CUBIC_TOLERANCE = 1.0e-9F;
+};
+
+/// Sine and cosine together, without branches or calls so that a loop over
+/// lanes vectorizes.
+///
+/// Reduces `x` by the nearest multiple of pi/2 in three parts (Cody and Waite),
+/// then evaluates the polynomials of `KeplerTraits`. Within an ulp or so of
+/// `std::sin` and `std::cos` for the angles SGP4 sees, which stay within a few
+/// multiples of 2pi. Not meant for huge arguments, where the reduction runs
+/// out of bits.
+template <typename Real>
+inline void lane_sincos(const Real x, Real &out_sin, Real &out_cos) {
+    using T = KeplerTraits<Real>;
+    const Real k = x * T::TWO_OVER_PI;
+    const int q = static_cast<int>(k + ((k >= Real(0.0)) ? Real(0.5) : Real(-0.5)));
+    const auto qr = static_cast<Real>(q);
+    const Real r = ((x - qr * T::PIO2_1) - qr * T::PIO2_2) - qr * T::PIO2_3;
+    const Real z = r * r;
+    const Real sin_r = r + r * z * T::sin_poly(z);
+    const Real cos_r = Real(1.0) - Real(0.5) * z + z * z * T::cos_poly(z);
+    // Quadrant `q mod 4`, which the low bits give even for negative `q`
+    const bool odd = (q & 1) != 0;
+    const Real s = odd ? cos_r : sin_r;
+    const Real c = odd ? sin_r : cos_r;
+    out_sin = ((q & 2) != 0) ? -s : s;
+    out_cos = (((q + 1) & 2) != 0) ? -c : c;
+}
+
+/// Solve SGP4's form of Kepler's equation, `u = E - axnl sin(E) + aynl cos(E)`
+/// for the eccentric longitude `E`, in `L` lanes at once.
+///
+/// All lanes iterate together, with converged lanes masked off. Each iteration
+/// is a Halley step from the last estimate, starting from `u` itself, so the
+/// first step is already the third-order series in the eccentricity. Halley
+/// costs the same sine and cosine per iteration as Newton, but converges
+/// cubically, which takes high eccentricity orbits from around five iterations
+/// down to three or four. The step is clamped to 0.95 like the original, and
+/// iterations are capped at 10.
+///
+/// Only the sine and cosine of `E` are returned, since they're all SGP4 needs.
+///
+/// @param u Mean longitude minus the node, in [0, 2pi)
+/// @param axnl Eccentricity times the cosine of the argument of perigee
+/// @param aynl Eccentricity times its sine, plus the long period periodics
+/// @param out_sin Returned sine of `E`
+/// @param out_cos Returned cosine of `E`
+/// @param out_iterations Returned number of iterations of each lane
+/// @param out_capped Returned if a lane was stopped by the cap of 10
+template <typename Real, std::size_t L>
+inline void solve_kepler(
+    const Real (&u)[L], const Real (&axnl)[L], const Real (&aynl)[L],
+    Real (&out_sin)[L], Real (&out_cos)[L], unsigned (&out_iterations)[L],
+    bool (&out_capped)[L]
+) {
+    using T = KeplerTraits<Real>;
+    // Work in local arrays, which the compiler knows don't alias
+    Real eo1[L], step[L], sineo1[L], coseo1[L];
+    // Masks as integers, since the compiler can't vectorize with bools
+    unsigned iterations[L], active[L];
+    for (std::size_t l = 0; l < L; ++l) {
+        eo1[l] = u[l];
+        step[l] = Real(0.0);
+        sineo1[l] = Real(0.0);
+        coseo1[l] = Real(1.0);
+        iterations[l] = 0;
+        active[l] = 1;
+    }
+    for (int ktr = 1; ktr <= 10; ++ktr) {
+        for (std::size_t l = 0; l < L; ++l) {
+            Real s, c;
+            lane_sincos(eo1[l], s, c);
+            const Real ecose = axnl[l] * c + aynl[l] * s;
+            const Real esine = axnl[l] * s - aynl[l] * c;
+            const Real g1 = Real(1.0) - ecose;
+            Real d = (u[l] - eo1[l] + esine) / g1;
+            d = d / (Real(1.0) + Real(0.5) * d * esine / g1);
+            d = (std::fabs(d) >= Real(0.95)) ? std::copysign(Real(0.95), d) : d;
+            // Bound on the error left after this step
+            const Real k = esine * esine / (Real(4.0) * g1 * g1)
+                + std::fabs(ecose) / (Real(6.0) * g1);
+            const Real ad = std::fabs(d);
+            // Bitwise operators, since short-circuiting would branch
+            const bool done = (ad < T::TOLERANCE)
+                | ((ad < Real(1.0e-4)) & (k * ad * ad * ad < T::CUBIC_TOLERANCE));
+
+            const bool is_active = active[l] != 0;
+            iterations[l] += active[l];
+            sineo1[l] = is_active ? s : sineo1[l];
+            coseo1[l] = is_active ? c : coseo1[l];
+            step[l] = is_active ? d : step[l];
+            eo1[l] = is_active ? eo1[l] + d : eo1[l];
+            active[l] = (is_active & !done) ? 1U : 0U;
+        }
+        unsigned any_active = 0;
+        for (std::size_t l = 0; l < L; ++l) {
+            any_active |= active[l];
+        }
+        if (any_active == 0) {
+            break;
+        }
+    }
+    // The sine and cosine are of the estimate before the last step, so rotate
+    // them by it. It's under 1e-4 when converged, so two terms are plenty.
+    for (std::size_t l = 0; l < L; ++l) {
+        const Real d = (active[l] != 0) ? Real(0.0) : step[l];
+        const Real sin_d = d - d * d * d / Real(6.0);
+        const Real cos_d = Real(1.0) - Real(0.5) * d * d;
+        out_sin[l] = sineo1[l] * cos_d + coseo1[l] * sin_d;
+        out_cos[l] = coseo1[l] * cos_d - sineo1[l] * sin_d;
+        out_iterations[l] = iterations[l];
+        out_capped[l] = active[l] != 0;
+    }
+}
+
+}  // namespace perturb
+
+#endif  // PERTURB_SRC_KEPLER_HPP
@@ -0,0 +1,120 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#ifndef PERTURB_DISABLE_IO
+
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace perturb {
+
+MappedFile::MappedFile(const char *path) {
+#if defined(_WIN32)
+    const HANDLE file = CreateFileA(
+        path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER file_size;
+        if (GetFileSizeEx(file, &file_size)) {
+            is_open_ = true;
+            size_ = static_cast<std::size_t>(file_size.QuadPart);
+        }
+        // Can't map an empty file, but it's still open
+        if (is_open_ && size_ > 0) {
+            const HANDLE mapping =
+                CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            const void *view = (mapping != nullptr)
+                ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+                : nullptr;
+            if (view != nullptr) {
+                mapping_ = mapping;
+                data_ = static_cast<const char *>(view);
+            } else if (mapping != nullptr) {
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#elif defined(__unix__) || defined(__APPLE__)
+    const int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            is_open_ = true;
+            size_ = static_cast<std::size_t>(st.st_size);
+        }
+        if (is_open_ && size_ > 0) {
+            void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                mapping_ = addr;
+                data_ = static_cast<const char *>(addr);
+            }
+        }
+        close(fd);
+    }
+#endif
+    // Fall back to reading the whole file if it couldn't be mapped
+    if (data_ == nullptr) {
+        std::ifstream in_file(path, std::ios::binary);
+        is_open_ = static_cast<bool>(in_file);
+        buffer_.assign(
+            std::istreambuf_iterator<char>(in_file), std::istreambuf_iterator<char>()
+        );
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (mapping_ == nullptr) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+#elif defined(__unix__) || defined(__APPLE__)
+    munmap(mapping_, size_);
+#endif
+}
+
+bool MappedFile::is_open() const {
+    return is_open_;
+}
+
+const char *MappedFile::data() const {
+    return data_;
+}
+
+std::size_t MappedFile::size() const {
+    return size_;
+}
+
+}  // namespace perturb
+
+#endif  // PERTURB_DISABLE_IO
@@ -0,0 +1,55 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+// Private read-only memory-mapped file, not installed
+
+#ifndef PERTURB_SRC_MAPPED_FILE_HPP
+#define PERTURB_SRC_MAPPED_FILE_HPP
+
+#ifndef PERTURB_DISABLE_IO
+
+#include <cstddef>
+#include <vector>
+
+namespace perturb {
+
+/// A whole file mapped read-only into memory.
+///
+/// Uses `mmap` on POSIX and a file mapping on Windows. If the file can't be
+/// mapped (or on other platforms), it's read into memory in one go instead.
+/// Either way, the data is aligned to at least 16 bytes.
+class MappedFile {
+public:
+    explicit MappedFile(const char *path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /// Whether the file could be opened, even if it's empty
+    bool is_open() const;
+
+    const char *data() const;
+    std::size_t size() const;
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+    bool is_open_ = false;
+    void *mapping_ = nullptr;   ///< Platform handle of the mapped file, if any
+    std::vector<char> buffer_;  ///< File contents, if it couldn't be mapped
+};
+
+}  // namespace perturb
+
+#endif  // PERTURB_DISABLE_IO
+
+#endif  // PERTURB_SRC_MAPPED_FILE_HPP
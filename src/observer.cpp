@@ -0,0 +1,494 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#include "perturb/observer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "common.hpp"
+
+namespace perturb {
+
+namespace {
+
+/// Check `up >= sin_mask * sqrt(range_sq)` without the square root
+bool above_mask(const double up, const double range_sq, const double sin_mask) {
+    const double up_sq = up * up;
+    const double mask_sq = sin_mask * sin_mask * range_sq;
+    return (sin_mask >= 0.0) ? (up >= 0.0 && up_sq >= mask_sq)
+                             : (up >= 0.0 || up_sq <= mask_sq);
+}
+
+/// Elevation of a satellite relative to a station's mask at one time point
+struct PassSample {
+    double t;          ///< Minutes since the start of the search
+    double h;          ///< `up - sin(mask) * range` in [km], positive above the mask
+    double rate;       ///< Elevation rate, scaled by `range / cos(elevation)`
+    double elevation;  ///< Elevation in [rad]
+};
+
+/// Propagates one satellite and looks at it from one station, for `find_passes`
+class PassSearch {
+public:
+    PassSearch(
+        const Satellite &sat, const GroundStation &station, const JulianDate start
+    )
+        : sat_(sat),
+          station_(station),
+          start_(start),
+          sin_mask_(std::sin(station.min_elevation())) {
+        // Bound the speed relative to the station from the perigee speed and the
+        // rotation of the frame at apogee, with some leeway for perturbations
+        constexpr double SPEED_MARGIN = 1.1;
+        const sgp4::elsetrec &rec = sat.sat_rec;
+        const double a = rec.radiusearthkm * std::pow(rec.xke / rec.no_kozai, 2.0 / 3.0);
+        const double e = std::min(rec.ecco, 0.999);
+        const double v_perigee = std::sqrt(rec.mus / a * (1 + e) / (1 - e));
+        const double max_speed = SPEED_MARGIN
+            * (v_perigee + EARTH_ROTATION_RATE * a * (1 + e));
+        // `h` changes no faster than the speed times its gradient
+        max_h_rate_ = (1 + std::fabs(sin_mask_)) * max_speed * SECS_PER_MIN;
+        min_step_ = (2 * PI / rec.no_kozai) / 256;
+    }
+
+    JulianDate jd(const double t) const {
+        return start_ + t / MINS_PER_DAY;
+    }
+
+    std::size_t n_evals() const {
+        return n_evals_;
+    }
+
+    Sgp4Error eval(const double t, PassSample &out) {
+        ++n_evals_;
+        StateVector sv;
+        const Sgp4Error err = sat_.propagate(jd(t), sv, state_);
+        if (err != Sgp4Error::NONE) {
+            return err;
+        }
+        const EcefState ecef = EarthRotation(sv.epoch).to_ecef(sv);
+        const Vec3 &p = station_.position();
+        const Vec3 &z = station_.zenith();
+        const Vec3 rho = { {
+            ecef.position[0] - p[0],
+            ecef.position[1] - p[1],
+            ecef.position[2] - p[2],
+        } };
+        const Vec3 &v = ecef.velocity;
+        const double up = z[0] * rho[0] + z[1] * rho[1] + z[2] * rho[2];
+        const double range =
+            std::sqrt(rho[0] * rho[0] + rho[1] * rho[1] + rho[2] * rho[2]);
+        const double range_rate =
+            (rho[0] * v[0] + rho[1] * v[1] + rho[2] * v[2]) / range;
+        const double sin_el = up / range;
+        out.t = t;
+        out.h = up - sin_mask_ * range;
+        out.rate = (z[0] * v[0] + z[1] * v[1] + z[2] * v[2]) - sin_el * range_rate;
+        out.elevation = std::asin(sin_el);
+        return Sgp4Error::NONE;
+    }
+
+    /// Largest step in minutes that can't cross the mask, at least `min_step_`
+    double step(const PassSample &s) const {
+        return std::max(std::fabs(s.h) / max_h_rate_, min_step_);
+    }
+
+    /// If `h` could reach the mask somewhere between two samples
+    bool may_cross(const PassSample &a, const PassSample &b) const {
+        return a.h + b.h + max_h_rate_ * (b.t - a.t) >= 0.0;
+    }
+
+    /// Narrow down the root of a field between two samples of opposite sign.
+    ///
+    /// Uses the Illinois variant of regula falsi, falling back to bisection if
+    /// it stalls. Returns the end of the final bracket where the field is not
+    /// negative, so that an AOS or LOS is just inside of its pass.
+    Sgp4Error refine(
+        PassSample a, PassSample b, double PassSample::*field, PassSample &out
+    ) {
+        const double tol = PASS_TIME_TOLERANCE / SECS_PER_MIN;
+        double fa = a.*field, fb = b.*field;
+        int side = 0;
+        bool bisect = false;
+        while (std::fabs(b.t - a.t) > tol) {
+            const double width = std::fabs(b.t - a.t);
+            double t = (a.t * fb - b.t * fa) / (fb - fa);
+            if (bisect || !(std::fabs(t - a.t) < width && std::fabs(t - b.t) < width)) {
+                t = (a.t + b.t) / 2;
+            }
+            PassSample m;
+            const Sgp4Error err = eval(t, m);
+            if (err != Sgp4Error::NONE) {
+                return err;
+            }
+            const double fm = m.*field;
+            if ((fm < 0) == (fb < 0)) {
+                b = m;
+                fb = fm;
+                if (side == -1) {
+                    fa /= 2;
+                }
+                side = -1;
+            } else {
+                a = m;
+                fa = fm;
+                if (side == 1) {
+                    fb /= 2;
+                }
+                side = 1;
+            }
+            bisect = std::fabs(b.t - a.t) > width / 2;
+        }
+        out = (a.*field >= 0) ? a : b;
+        return Sgp4Error::NONE;
+    }
+
+private:
+    const Satellite &sat_;
+    const GroundStation &station_;
+    JulianDate start_;
+    double sin_mask_;
+    double max_h_rate_;  ///< Bound on the rate of change of `h` in [km/min]
+    double min_step_;    ///< Smallest step in [min]
+    sgp4::elsetrec_state state_ {};
+    std::size_t n_evals_ = 0;
+};
+
+}  // namespace
+
+GroundStation::GroundStation(const Geodetic &location, const double min_elevation)
+    : location_(location),
+      position_(to_ecef(location)),
+      min_elevation_(min_elevation),
+      sin_min_elevation_(std::sin(min_elevation)) {
+    const double sin_lat = std::sin(location.latitude);
+    const double cos_lat = std::cos(location.latitude);
+    const double sin_lon = std::sin(location.longitude);
+    const double cos_lon = std::cos(location.longitude);
+    south_ = Vec3 { { sin_lat * cos_lon, sin_lat * sin_lon, -cos_lat } };
+    east_ = Vec3 { { -sin_lon, cos_lon, 0.0 } };
+    zenith_ = Vec3 { { cos_lat * cos_lon, cos_lat * sin_lon, sin_lat } };
+}
+
+const Geodetic &GroundStation::location() const {
+    return location_;
+}
+
+const Vec3 &GroundStation::position() const {
+    return position_;
+}
+
+double GroundStation::min_elevation() const {
+    return min_elevation_;
+}
+
+const Vec3 &GroundStation::zenith() const {
+    return zenith_;
+}
+
+Vec3 GroundStation::to_sez(const Vec3 &ecef) const {
+    return Vec3 { {
+        south_[0] * ecef[0] + south_[1] * ecef[1] + south_[2] * ecef[2],
+        east_[0] * ecef[0] + east_[1] * ecef[1],
+        zenith_[0] * ecef[0] + zenith_[1] * ecef[1] + zenith_[2] * ecef[2],
+    } };
+}
+
+LookAngles GroundStation::look_at(const EcefState &sat) const {
+    const Vec3 rho = { {
+        sat.position[0] - position_[0],
+        sat.position[1] - position_[1],
+        sat.position[2] - position_[2],
+    } };
+    const Vec3 sez = to_sez(rho);
+    LookAngles look;
+    look.range = std::sqrt(rho[0] * rho[0] + rho[1] * rho[1] + rho[2] * rho[2]);
+    look.elevation = std::asin(sez[2] / look.range);
+    look.azimuth = std::atan2(sez[1], -sez[0]);
+    if (look.azimuth < 0.0) {
+        look.azimuth += 2 * PI;
+    }
+    // The station is fixed in ECEF, so the relative velocity is the satellite's
+    look.range_rate = (rho[0] * sat.velocity[0] + rho[1] * sat.velocity[1]
+                       + rho[2] * sat.velocity[2])
+        / look.range;
+    return look;
+}
+
+bool GroundStation::is_visible(const Vec3 &sat_position) const {
+    const Vec3 rho = { {
+        sat_position[0] - position_[0],
+        sat_position[1] - position_[1],
+        sat_position[2] - position_[2],
+    } };
+    return above_mask(
+        zenith_[0] * rho[0] + zenith_[1] * rho[1] + zenith_[2] * rho[2],
+        rho[0] * rho[0] + rho[1] * rho[1] + rho[2] * rho[2], sin_min_elevation_
+    );
+}
+
+StationNetwork::StationNetwork() = default;
+
+StationNetwork::StationNetwork(const std::vector<GroundStation> &stations)
+    : stations_(stations) {}
+
+void StationNetwork::add(const GroundStation &station) {
+    stations_.push_back(station);
+}
+
+std::size_t StationNetwork::size() const {
+    return stations_.size();
+}
+
+const GroundStation &StationNetwork::operator[](const std::size_t i) const {
+    return stations_[i];
+}
+
+std::size_t StationNetwork::look_angles(
+    const StateVector *sv, const std::size_t n_sats, const Sgp4Error *sv_err,
+    std::vector<Visibility> &out, const EarthOrientation &eop
+) {
+    sat_idx_.clear();
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    vx_.clear();
+    vy_.clear();
+    vz_.clear();
+    if (n_sats == 0) {
+        return 0;
+    }
+    const EarthRotation rot(sv[0].epoch, eop);
+    for (std::size_t i = 0; i < n_sats; ++i) {
+        if (sv_err && sv_err[i] != Sgp4Error::NONE) {
+            continue;
+        }
+        const EcefState ecef = rot.to_ecef(sv[i]);
+        sat_idx_.push_back(i);
+        x_.push_back(ecef.position[0]);
+        y_.push_back(ecef.position[1]);
+        z_.push_back(ecef.position[2]);
+        vx_.push_back(ecef.velocity[0]);
+        vy_.push_back(ecef.velocity[1]);
+        vz_.push_back(ecef.velocity[2]);
+    }
+    return look_angles_columns(out);
+}
+
+std::size_t StationNetwork::look_angles(
+    const EcefState *sats, const std::size_t n_sats, std::vector<Visibility> &out
+) {
+    sat_idx_.resize(n_sats);
+    x_.resize(n_sats);
+    y_.resize(n_sats);
+    z_.resize(n_sats);
+    vx_.resize(n_sats);
+    vy_.resize(n_sats);
+    vz_.resize(n_sats);
+    for (std::size_t i = 0; i < n_sats; ++i) {
+        sat_idx_[i] = i;
+        x_[i] = sats[i].position[0];
+        y_[i] = sats[i].position[1];
+        z_[i] = sats[i].position[2];
+        vx_[i] = sats[i].velocity[0];
+        vy_[i] = sats[i].velocity[1];
+        vz_[i] = sats[i].velocity[2];
+    }
+    return look_angles_columns(out);
+}
+
+std::size_t StationNetwork::look_angles_columns(std::vector<Visibility> &out) {
+    const std::size_t n = sat_idx_.size();
+    const std::size_t n_before = out.size();
+    zenith_.resize(n);
+    range_sq_.resize(n);
+    const double *x = x_.data(), *y = y_.data(), *z = z_.data();
+    double *up = zenith_.data(), *range_sq = range_sq_.data();
+
+    for (std::size_t s = 0; s < stations_.size(); ++s) {
+        const GroundStation &station = stations_[s];
+        const double px = station.position()[0];
+        const double py = station.position()[1];
+        const double pz = station.position()[2];
+        const double ux = station.zenith()[0];
+        const double uy = station.zenith()[1];
+        const double uz = station.zenith()[2];
+        // Branch-free and without a square root, so this loop vectorizes
+        for (std::size_t i = 0; i < n; ++i) {
+            const double rx = x[i] - px;
+            const double ry = y[i] - py;
+            const double rz = z[i] - pz;
+            up[i] = ux * rx + uy * ry + uz * rz;
+            range_sq[i] = rx * rx + ry * ry + rz * rz;
+        }
+        const double sin_mask = std::sin(station.min_elevation());
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!above_mask(up[i], range_sq[i], sin_mask)) {
+                continue;
+            }
+            EcefState sat;
+            sat.position = Vec3 { { x[i], y[i], z[i] } };
+            sat.velocity = Vec3 { { vx_[i], vy_[i], vz_[i] } };
+            Visibility vis;
+            vis.station = s;
+            vis.satellite = sat_idx_[i];
+            vis.look = station.look_at(sat);
+            out.push_back(vis);
+        }
+    }
+    return out.size() - n_before;
+}
+
+Sgp4Error find_passes(
+    const Satellite &sat, const GroundStation &station, const JulianDate start,
+    const JulianDate end, std::vector<Pass> &out, std::size_t *out_n_evals
+) {
+    if (out_n_evals) {
+        *out_n_evals = 0;
+    }
+    if (sat.last_error() != Sgp4Error::NONE) {
+        return sat.last_error();
+    }
+    PassSearch search(sat, station, start);
+    const double t_end = (end - start) * MINS_PER_DAY;
+    Pass pass {};
+    PassSample best {};  // Highest point of the current pass so far
+    bool in_pass = false;
+    const auto check_max = [&](const PassSample &a, const PassSample &b) {
+        PassSample top;
+        if (a.rate <= 0 || b.rate > 0) {
+            return Sgp4Error::NONE;
+        }
+        const Sgp4Error err = search.refine(a, b, &PassSample::rate, top);
+        if (err == Sgp4Error::NONE && top.elevation > best.elevation) {
+            best = top;
+        }
+        return err;
+    };
+    const auto finish_pass = [&](const JulianDate los) {
+        pass.tca = search.jd(best.t);
+        pass.max_elevation = best.elevation;
+        pass.los = los;
+        out.push_back(pass);
+        in_pass = false;
+    };
+
+    PassSample prev;
+    Sgp4Error err = search.eval(0.0, prev);
+    if (err == Sgp4Error::NONE && prev.h >= 0) {
+        in_pass = true;
+        pass.aos = start;
+        best = prev;
+    }
+    while (err == Sgp4Error::NONE && prev.t < t_end) {
+        PassSample next;
+        // Back off if propagation fails, to get as close as possible to where
+        for (double step = search.step(prev);; step /= 2) {
+            err = search.eval(std::min(prev.t + step, t_end), next);
+            if (err == Sgp4Error::NONE || step < PASS_TIME_TOLERANCE / SECS_PER_MIN) {
+                break;
+            }
+        }
+        if (err != Sgp4Error::NONE) {
+            break;
+        }
+        if (!in_pass && next.h < 0) {
+            // Both ends are below the mask, but a short pass could fit in between
+            if (prev.rate > 0 && next.rate <= 0 && search.may_cross(prev, next)) {
+                PassSample top, aos, los;
+                err = search.refine(prev, next, &PassSample::rate, top);
+                if (err == Sgp4Error::NONE && top.h >= 0) {
+                    err = search.refine(prev, top, &PassSample::h, aos);
+                    if (err == Sgp4Error::NONE) {
+                        err = search.refine(top, next, &PassSample::h, los);
+                    }
+                    if (err == Sgp4Error::NONE) {
+                        pass.aos = search.jd(aos.t);
+                        best = top;
+                        finish_pass(search.jd(los.t));
+                    }
+                }
+            }
+            prev = next;
+            continue;
+        }
+        if (!in_pass) {
+            PassSample aos;
+            err = search.refine(prev, next, &PassSample::h, aos);
+            if (err != Sgp4Error::NONE) {
+                break;
+            }
+            in_pass = true;
+            pass.aos = search.jd(aos.t);
+            best = aos;
+            prev = aos;
+        }
+        if (next.h >= 0) {
+            err = check_max(prev, next);
+        } else {
+            PassSample los;
+            err = search.refine(prev, next, &PassSample::h, los);
+            if (err == Sgp4Error::NONE) {
+                err = check_max(prev, los);
+            }
+            if (err == Sgp4Error::NONE) {
+                finish_pass(search.jd(los.t));
+            }
+        }
+        prev = next;
+    }
+    if (in_pass) {
+        if (prev.elevation > best.elevation) {
+            best = prev;
+        }
+        finish_pass((err == Sgp4Error::NONE) ? end : search.jd(prev.t));
+    }
+    if (out_n_evals) {
+        *out_n_evals = search.n_evals();
+    }
+    return err;
+}
+
+std::size_t StationNetwork::find_passes(
+    const Satellite *sats, const std::size_t n_sats, const JulianDate start,
+    const JulianDate end, std::vector<StationPass> &out, const std::size_t n_threads
+) const {
+    std::vector<std::vector<StationPass>> sat_passes(n_sats);
+    std::vector<char> failed(n_sats, 0);
+    parallel_for_blocks(
+        n_sats, 1, n_threads,
+        [&](const std::size_t begin, const std::size_t block_end) {
+            std::vector<Pass> passes;
+            for (std::size_t i = begin; i < block_end; ++i) {
+                for (std::size_t s = 0; s < stations_.size(); ++s) {
+                    passes.clear();
+                    const auto err =
+                        perturb::find_passes(sats[i], stations_[s], start, end, passes);
+                    failed[i] |= static_cast<char>(err != Sgp4Error::NONE);
+                    for (const Pass &pass : passes) {
+                        sat_passes[i].push_back(StationPass { s, i, pass });
+                    }
+                }
+            }
+        }
+    );
+    std::size_t n_failed = 0;
+    for (std::size_t i = 0; i < n_sats; ++i) {
+        out.insert(out.end(), sat_passes[i].begin(), sat_passes[i].end());
+        n_failed += static_cast<std::size_t>(failed[i]);
+    }
+    return n_failed;
+}
+
+}  // namespace perturb
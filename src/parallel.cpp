@@ -0,0 +1,199 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#include "perturb/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace perturb {
+
+namespace {
+
+/// A block of catalog satellites propagated over a block of time points
+struct Task {
+    std::size_t first, last;
+    std::size_t time_begin, time_end;
+};
+
+/// Tasks owned by one worker, which other workers can steal from
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+}  // namespace
+
+struct ParallelPropagator::Pool {
+    explicit Pool(std::size_t n_threads) : queues(n_threads) {}
+
+    // The owner takes from the back, while thieves take from the front, so
+    // that they're working on opposite ends of the owner's share
+    bool pop(std::size_t worker, Task &task) {
+        WorkerQueue &own = queues[worker];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t i = 1; i < queues.size(); ++i) {
+            WorkerQueue &victim = queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(std::size_t worker) {
+        std::size_t seen_generation = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() {
+                    return stopping || generation != seen_generation;
+                });
+                if (stopping) {
+                    return;
+                }
+                seen_generation = generation;
+            }
+            // No new tasks are added during a job, so once every queue is
+            // empty this worker is done
+            Task task {};
+            std::size_t worker_failed = 0;
+            while (pop(worker, task)) {
+                worker_failed += catalog->propagate_grid(
+                    task.first, task.last, times + task.time_begin,
+                    task.time_end - task.time_begin,
+                    out_sv + task.time_begin * catalog->size(),
+                    out_err ? out_err + task.time_begin * catalog->size() : nullptr
+                );
+            }
+            n_failed += worker_failed;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--n_busy == 0) {
+                    done.notify_all();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<WorkerQueue> queues;
+
+    std::mutex mutex;
+    std::condition_variable wake;  ///< Signals workers to start a job or stop
+    std::condition_variable done;  ///< Signals the caller that a job is done
+    std::size_t generation = 0;    ///< Incremented for every new job
+    std::size_t n_busy = 0;        ///< Workers still working on the current job
+    bool stopping = false;
+
+    // Current job
+    const SatelliteCatalog *catalog = nullptr;
+    const JulianDate *times = nullptr;
+    StateVector *out_sv = nullptr;
+    Sgp4Error *out_err = nullptr;
+    std::atomic<std::size_t> n_failed {0};
+};
+
+ParallelPropagator::ParallelPropagator(std::size_t n_threads) {
+    if (n_threads == 0) {
+        n_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    pool_.reset(new Pool(n_threads));
+    pool_->threads.reserve(n_threads);
+    for (std::size_t i = 0; i < n_threads; ++i) {
+        pool_->threads.emplace_back(&Pool::run, pool_.get(), i);
+    }
+}
+
+ParallelPropagator::~ParallelPropagator() {
+    {
+        std::lock_guard<std::mutex> lock(pool_->mutex);
+        pool_->stopping = true;
+    }
+    pool_->wake.notify_all();
+    for (auto &thread : pool_->threads) {
+        thread.join();
+    }
+}
+
+std::size_t ParallelPropagator::thread_count() const {
+    return pool_->threads.size();
+}
+
+std::size_t ParallelPropagator::propagate(
+    const SatelliteCatalog &catalog, const JulianDate *times, const std::size_t n_times,
+    StateVector *out_sv, Sgp4Error *out_err
+) {
+    if (catalog.size() == 0 || n_times == 0) {
+        return 0;
+    }
+    Pool &pool = *pool_;
+    const std::size_t n_workers = pool.queues.size();
+
+    // Only split up the times if there aren't enough satellite tasks
+    const std::size_t n_sat_tasks =
+        (catalog.size() + PARALLEL_TASK_SATS - 1) / PARALLEL_TASK_SATS;
+    const std::size_t min_tasks = PARALLEL_TASKS_PER_THREAD * n_workers;
+    const std::size_t n_time_tasks = std::min(
+        n_times, std::max<std::size_t>(1, (min_tasks + n_sat_tasks - 1) / n_sat_tasks)
+    );
+    const std::size_t task_times = (n_times + n_time_tasks - 1) / n_time_tasks;
+
+    std::vector<Task> tasks;
+    for (std::size_t first = 0; first < catalog.size(); first += PARALLEL_TASK_SATS) {
+        const std::size_t last = std::min(first + PARALLEL_TASK_SATS, catalog.size());
+        for (std::size_t k = 0; k < n_times; k += task_times) {
+            tasks.push_back(Task {first, last, k, std::min(k + task_times, n_times)});
+        }
+    }
+
+    // Give each worker an even contiguous share to start with, and let
+    // stealing even out any imbalance from there
+    for (std::size_t w = 0; w < n_workers; ++w) {
+        const std::size_t begin = tasks.size() * w / n_workers;
+        const std::size_t end = tasks.size() * (w + 1) / n_workers;
+        std::lock_guard<std::mutex> lock(pool.queues[w].mutex);
+        pool.queues[w].tasks.assign(
+            tasks.begin() + static_cast<std::ptrdiff_t>(begin),
+            tasks.begin() + static_cast<std::ptrdiff_t>(end)
+        );
+    }
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.catalog = &catalog;
+    pool.times = times;
+    pool.out_sv = out_sv;
+    pool.out_err = out_err;
+    pool.n_failed = 0;
+    pool.n_busy = n_workers;
+    ++pool.generation;
+    pool.wake.notify_all();
+    pool.done.wait(lock, [&]() { return pool.n_busy == 0; });
+    return pool.n_failed;
+}
+
+}  // namespace perturb
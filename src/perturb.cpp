@@ -14,29 +14,11 @@
 #include <cmath>
 #include <cstring>
 
+#include "common.hpp"
 #include "perturb/sgp4.hpp"
 
 namespace perturb {
 
-static constexpr double MINS_PER_DAY = 24 * 60;
-static constexpr double PI = 3.14159265358979323846;
-
-static Sgp4Error convert_sgp4_error_code(const int error_code) {
-    if (error_code < 0 || error_code >= static_cast<int>(Sgp4Error::UNKNOWN)) {
-        return Sgp4Error::UNKNOWN;
-    }
-    return static_cast<Sgp4Error>(error_code);
-}
-
-static sgp4::gravconsttype convert_grav_model(const GravModel model) {
-    switch (model) {
-        case GravModel::WGS72_OLD: return sgp4::wgs72old;
-        case GravModel::WGS72: return sgp4::wgs72;
-        case GravModel::WGS84: return sgp4::wgs84;
-        default: return sgp4::wgs72;
-    }
-}
-
 JulianDate::JulianDate() : jd(0), jd_frac(0) {}
 
 JulianDate::JulianDate(double _jd) : jd(_jd), jd_frac(0) {}
@@ -133,6 +115,12 @@ ClassicalOrbitalElements::ClassicalOrbitalElements(
 Satellite::Satellite(const sgp4::elsetrec _sat_rec) : sat_rec(_sat_rec) {}
 
 Satellite::Satellite(const TwoLineElement &tle, GravModel grav_model) : sat_rec({}) {
+    init_sat_rec(tle, grav_model, sat_rec);
+}
+
+void init_sat_rec(
+    const TwoLineElement &tle, const GravModel grav_model, sgp4::elsetrec &sat_rec
+) {
     constexpr double DEG_TO_RAD = PI / 180.0;
     constexpr double XP_DOT_P = 1440.0 / (2 * PI);
 
@@ -240,4 +228,181 @@ Sgp4Error Satellite::propagate(const JulianDate jd, StateVector &sv) {
     sv.epoch = jd;  // Can save some math, ignore value from `propagate_from_epoch`
     return err;
 }
+
+Sgp4Error Satellite::propagate_from_epoch(
+    double mins_from_epoch, StateVector &sv
+) const {
+    sv.epoch = epoch() + (mins_from_epoch / MINS_PER_DAY);
+    sgp4::elsetrec_state state {};
+    const bool is_valid = sgp4::sgp4(
+        sat_rec, state, mins_from_epoch, sv.position.data(), sv.velocity.data()
+    );
+    (void) is_valid;  // Unused because it is consistent with error code
+    return convert_sgp4_error_code(state.error);
+}
+
+Sgp4Error Satellite::propagate(const JulianDate jd, StateVector &sv) const {
+    sgp4::elsetrec_state state {};
+    return propagate(jd, sv, state);
+}
+
+Sgp4Error Satellite::propagate(
+    const JulianDate jd, StateVector &sv, sgp4::elsetrec_state &state
+) const {
+    const double delta_jd = jd - epoch();
+    const double mins_from_epoch = delta_jd * MINS_PER_DAY;
+    sv.epoch = jd;
+    const bool is_valid = sgp4::sgp4(
+        sat_rec, state, mins_from_epoch, sv.position.data(), sv.velocity.data()
+    );
+    (void) is_valid;  // Unused because it is consistent with error code
+    return convert_sgp4_error_code(state.error);
+}
+
+Sgp4Error Satellite::propagate_range(
+    const JulianDate start, const double step_sec, const std::size_t count,
+    StateVector *out, std::size_t *n_valid
+) const {
+    const double start_mins = (start - epoch()) * MINS_PER_DAY;
+    const double step_mins = step_sec / SECS_PER_MIN;
+    const double step_days = step_sec / SECS_PER_DAY;
+    // Carried across steps, so deep-space integration doesn't restart each time
+    sgp4::elsetrec_state state {};
+    Sgp4Error err = Sgp4Error::NONE;
+    std::size_t k = 0;
+    for (; k < count; ++k) {
+        // Offsets from `start` instead of accumulating, so errors don't build up
+        const auto k_dbl = static_cast<double>(k);
+        StateVector &sv = out[k];
+        sv.epoch = start + k_dbl * step_days;
+        const bool is_valid = sgp4::sgp4(
+            sat_rec, state, start_mins + k_dbl * step_mins, sv.position.data(),
+            sv.velocity.data()
+        );
+        if (!is_valid) {
+            err = convert_sgp4_error_code(state.error);
+            break;
+        }
+    }
+    if (n_valid) {
+        *n_valid = k;
+    }
+    return err;
+}
+
+Sgp4Error Satellite::propagate(
+    const JulianDate jd, StateVector &sv, sgp4::elsetrec_state &state,
+    ResonanceCheckpoints &checkpoints
+) const {
+    const double delta_jd = jd - epoch();
+    const double mins_from_epoch = delta_jd * MINS_PER_DAY;
+    checkpoints.resume(*this, mins_from_epoch, state);
+    sv.epoch = jd;
+    const bool is_valid = sgp4::sgp4(
+        sat_rec, state, mins_from_epoch, sv.position.data(), sv.velocity.data()
+    );
+    (void) is_valid;  // Unused because it is consistent with error code
+    return convert_sgp4_error_code(state.error);
+}
+
+ResonanceCheckpoints::ResonanceCheckpoints()
+    : forward_ {0, RESONANCE_CHECKPOINT_STEPS, {}, {}, {}},
+      backward_ {0, RESONANCE_CHECKPOINT_STEPS, {}, {}, {}} {}
+
+void ResonanceCheckpoints::resume(
+    const Satellite &sat, const double mins_from_epoch, sgp4::elsetrec_state &state
+) {
+    // Same step size as `dspace` in the SGP4 impl
+    constexpr double STEP_MINS = 720.0;
+    const sgp4::elsetrec &rec = sat.sat_rec;
+    if (rec.method != 'd' || rec.irez == 0 || mins_from_epoch == 0.0) {
+        return;
+    }
+    const bool is_forward = (mins_from_epoch > 0.0);
+    Side &side = is_forward ? forward_ : backward_;
+    const double sign = is_forward ? 1.0 : -1.0;
+    const auto n_steps =
+        static_cast<std::size_t>(std::fabs(mins_from_epoch) / STEP_MINS);
+
+    // Find the last snapshot at or before `n_steps`, creating any missing ones
+    std::size_t idx = 0;
+    for (;;) {
+        const std::size_t n_snapshots = n_steps / side.steps;
+        if (n_snapshots == 0) {
+            return;
+        }
+        idx = n_snapshots - 1;
+        if (idx < side.count) {
+            break;
+        }
+        if (side.count == RESONANCE_CHECKPOINTS) {
+            // Keep every other snapshot and double the spacing
+            for (std::size_t i = 0; i < RESONANCE_CHECKPOINTS / 2; ++i) {
+                side.atime[i] = side.atime[2 * i + 1];
+                side.xli[i] = side.xli[2 * i + 1];
+                side.xni[i] = side.xni[2 * i + 1];
+            }
+            side.count = RESONANCE_CHECKPOINTS / 2;
+            side.steps *= 2;
+            continue;
+        }
+        // Integrate exactly to the next snapshot, starting from the previous
+        sgp4::elsetrec_state tmp {};
+        if (side.count > 0) {
+            tmp.atime = side.atime[side.count - 1];
+            tmp.xli = side.xli[side.count - 1];
+            tmp.xni = side.xni[side.count - 1];
+        }
+        const double snapshot_mins =
+            sign * static_cast<double>((side.count + 1) * side.steps) * STEP_MINS;
+        double r[3], v[3];
+        (void) sgp4::sgp4(rec, tmp, snapshot_mins, r, v);
+        side.atime[side.count] = tmp.atime;
+        side.xli[side.count] = tmp.xli;
+        side.xni[side.count] = tmp.xni;
+        ++side.count;
+    }
+
+    // Only move `state` if it isn't already closer on the same side of epoch
+    const bool state_usable = (state.atime != 0.0)
+        && (state.atime * mins_from_epoch > 0.0)
+        && (std::fabs(state.atime) <= std::fabs(mins_from_epoch));
+    if (state_usable && std::fabs(state.atime) >= std::fabs(side.atime[idx])) {
+        return;
+    }
+    state.atime = side.atime[idx];
+    state.xli = side.xli[idx];
+    state.xni = side.xni[idx];
+}
+
+std::size_t ResonanceCheckpoints::size() const {
+    return forward_.count + backward_.count;
+}
+
+std::size_t propagate_batch(
+    Satellite *sats, std::size_t n_sats, const JulianDate jd, StateVector *out_sv,
+    Sgp4Error *out_err
+) {
+    std::size_t n_failed = 0;
+    for (std::size_t i = 0; i < n_sats; ++i) {
+        sgp4::elsetrec &sat_rec = sats[i].sat_rec;
+        StateVector &sv = out_sv[i];
+        // Same grouping as `JulianDate::operator-`, so results match `propagate`
+        const double delta_jd =
+            (jd.jd - sat_rec.jdsatepoch) + (jd.jd_frac - sat_rec.jdsatepochF);
+        sv.epoch = jd;
+        const bool is_valid = sgp4::sgp4(
+            sat_rec, delta_jd * MINS_PER_DAY, sv.position.data(), sv.velocity.data()
+        );
+        (void) is_valid;  // Unused because it is consistent with error code
+        const Sgp4Error err = convert_sgp4_error_code(sat_rec.error);
+        if (err != Sgp4Error::NONE) {
+            ++n_failed;
+        }
+        if (out_err) {
+            out_err[i] = err;
+        }
+    }
+    return n_failed;
+}
 }  // namespace perturb
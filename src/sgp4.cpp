@@ -58,6 +58,13 @@
 
 #include "perturb/sgp4.hpp"
 
+// perturb: hooks for the optional propagation statistics
+#ifdef PERTURB_ENABLE_STATS
+#include "common.hpp"
+#endif
+// perturb: fused trigonometry for the optional fast math mode
+#include "fast_math.hpp"
+
 // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers)
 
 // NOLINTBEGIN(hicpp-deprecated-headers, modernize-deprecated-headers)
@@ -253,7 +260,7 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             f2, f3, pe, pgh, ph, pinc, pl,
             sel, ses, sghl, sghs, shll, shs, sil,
             sinip, sinop, sinzf, sis, sll, sls, xls,
-            xnoh, zf, zm, zel, zes, znl, zns;
+            xnoh, zf, zm, zel, zes, znl, zns, coszf;
 
         /* ---------------------- constants ----------------------------- */
         zns = 1.19459e-5;
@@ -267,9 +274,9 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         if (init == 'y')
             zm = zmos;
         zf = zm + 2.0 * zes * sin(zm);
-        sinzf = sin(zf);
+        hot_sincos(zf, sinzf, coszf);  // perturb: fused in fast math mode
         f2 = 0.5 * sinzf * sinzf - 0.25;
-        f3 = -0.5 * sinzf * cos(zf);
+        f3 = -0.5 * sinzf * coszf;
         ses = se2* f2 + se3 * f3;
         sis = si2 * f2 + si3 * f3;
         sls = sl2 * f2 + sl3 * f3 + sl4 * sinzf;
@@ -279,9 +286,9 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         if (init == 'y')
             zm = zmol;
         zf = zm + 2.0 * zel * sin(zm);
-        sinzf = sin(zf);
+        hot_sincos(zf, sinzf, coszf);  // perturb: fused in fast math mode
         f2 = 0.5 * sinzf * sinzf - 0.25;
-        f3 = -0.5 * sinzf * cos(zf);
+        f3 = -0.5 * sinzf * coszf;
         sel = ee2 * f2 + e3 * f3;
         sil = xi2 * f2 + xi3 * f3;
         sll = xl2 * f2 + xl3 * f3 + xl4 * sinzf;
@@ -302,8 +309,7 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             ph = ph - pho;
             inclp = inclp + pinc;
             ep = ep + pe;
-            sinip = sin(inclp);
-            cosip = cos(inclp);
+            hot_sincos(inclp, sinip, cosip);  // perturb: fused in fast math mode
 
             /* ----------------- apply periodics directly ------------ */
             //  sgp4fix for lyddane choice
@@ -325,15 +331,17 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             else
             {
                 /* ---- apply periodics with lyddane modification ---- */
-                sinop = sin(nodep);
-                cosop = cos(nodep);
+#ifdef PERTURB_ENABLE_STATS
+                ++local_stats().lyddane;  // perturb: count for the stats
+#endif
+                hot_sincos(nodep, sinop, cosop);  // perturb: fused in fast math mode
                 alfdp = sinip * sinop;
                 betdp = sinip * cosop;
                 dalf = ph * cosop + pinc * cosip * sinop;
                 dbet = -ph * sinop + pinc * cosip * cosop;
                 alfdp = alfdp + dalf;
                 betdp = betdp + dbet;
-                nodep = fmod(nodep, twopi);
+                nodep = hot_fmod(nodep, twopi);  // perturb: cheaper in fast math mode
                 //  sgp4fix for afspc written intrinsic functions
                 // nodep used without a trigonometric function ahead
                 if ((nodep < 0.0) && (opsmode == 'a'))
@@ -1140,6 +1148,9 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
 
                 if (iretn == 381)
                 {
+#ifdef PERTURB_ENABLE_STATS
+                    ++local_stats().dspace_steps;  // perturb: count for the stats
+#endif
                     xli = xli + xldot * delt + xndt * step2;
                     xni = xni + xndt * delt + xnddt * step2;
                     atime = atime + delt;
@@ -1405,6 +1416,12 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             qzms2t, ss, x2o3, r[3], v[3],
             delmotemp, qzms2ttemp, qzms24temp;
 
+#ifdef PERTURB_ENABLE_STATS
+        // perturb: count and time every call for the stats
+        ++local_stats().n_inits;
+        const StatsTimer timer(local_stats().init_nanos);
+#endif
+
         /* ------------------------ initialization --------------------- */
         // sgp4fix divisor for divide by zero check on inclination
         // the old check used 1.0 + cos(pi-1.0e-9), but then compared it to
@@ -1766,25 +1783,25 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
     *    vallado, crawford, hujsak, kelso  2006
     ----------------------------------------------------------------------------*/
 
-    bool sgp4
+    // perturb: the part of the const core below up to the Kepler solve, which
+    // `sgp4_long_period` exposes on its own for batched solvers
+    template <typename Record>
+    static bool sgp4_long_period_core
         (
-        elsetrec& satrec, double tsince,
-        double r[3], double v[3]
+        const Record& satrec, elsetrec_state& state, double tsince,
+        elsetrec_periodics& out
         )
     {
-        double am, axnl, aynl, betal, cosim, cnod,
-            cos2u, coseo1, cosi, cosip, cosisq, cossu, cosu,
-            delm, delomg, em, emsq, ecose, el2, eo1,
-            ep, esine, argpm, argpp, argpdf, pl, mrt = 0.0,
-            mvt, rdotl, rl, rvdot, rvdotl, sinim,
-            sin2u, sineo1, sini, sinip, sinsu, sinu,
-            snod, su, t2, t3, t4, tem5, temp,
-            temp1, temp2, tempa, tempe, templ, u, ux,
-            uy, uz, vx, vy, vz, inclm, mm,
-            nm, nodem, xinc, xincp, xl, xlm, mp,
-            xmdf, xmx, xmy, nodedf, xnode, nodep, tc, dndt,
-            twopi, x2o3, vkmpersec, delmtemp;
-        int ktr;
+        double am, axnl, aynl, cosim, cosip,
+            delm, delomg, em, emsq,
+            ep, argpm, argpp, argpdf, sinim,
+            sinip, t2, t3, t4, temp,
+            tempa, tempe, templ, inclm, mm,
+            nm, nodem, xincp, xl, xlm, mp,
+            xmdf, nodedf, nodep, tc, dndt,
+            twopi, x2o3, delmtemp, sinargpp, cosargpp;
+        // perturb: deep space recomputes these every call, so keep them local
+        double aycof = satrec.aycof, xlcof = satrec.xlcof;
 
         /* ------------------ set mathematical constants --------------- */
         // sgp4fix divisor for divide by zero check on inclination
@@ -1793,29 +1810,26 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         const double temp4 = 1.5e-12;
         twopi = 2.0 * pi;
         x2o3 = 2.0 / 3.0;
-        // sgp4fix identify constants and allow alternate values
-        // getgravconst( whichconst, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2 );
-        vkmpersec = satrec.radiusearthkm * satrec.xke / 60.0;
 
         /* --------------------- clear sgp4 error flag ----------------- */
-        satrec.t = tsince;
-        satrec.error = 0;
+        state.t = tsince;
+        state.error = 0;
 
         /* ------- update for secular gravity and atmospheric drag ----- */
-        xmdf = satrec.mo + satrec.mdot * satrec.t;
-        argpdf = satrec.argpo + satrec.argpdot * satrec.t;
-        nodedf = satrec.nodeo + satrec.nodedot * satrec.t;
+        xmdf = satrec.mo + satrec.mdot * state.t;
+        argpdf = satrec.argpo + satrec.argpdot * state.t;
+        nodedf = satrec.nodeo + satrec.nodedot * state.t;
         argpm = argpdf;
         mm = xmdf;
-        t2 = satrec.t * satrec.t;
+        t2 = state.t * state.t;
         nodem = nodedf + satrec.nodecf * t2;
-        tempa = 1.0 - satrec.cc1 * satrec.t;
-        tempe = satrec.bstar * satrec.cc4 * satrec.t;
+        tempa = 1.0 - satrec.cc1 * state.t;
+        tempe = satrec.bstar * satrec.cc4 * state.t;
         templ = satrec.t2cof * t2;
 
         if (satrec.isimp != 1)
         {
-            delomg = satrec.omgcof * satrec.t;
+            delomg = satrec.omgcof * state.t;
             // sgp4fix use mutliply for speed instead of pow
             delmtemp = 1.0 + satrec.eta * cos(xmdf);
             delm = satrec.xmcof *
@@ -1824,14 +1838,14 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             temp = delomg + delm;
             mm = xmdf + temp;
             argpm = argpdf - temp;
-            t3 = t2 * satrec.t;
-            t4 = t3 * satrec.t;
+            t3 = t2 * state.t;
+            t4 = t3 * state.t;
             tempa = tempa - satrec.d2 * t2 - satrec.d3 * t3 -
                 satrec.d4 * t4;
             tempe = tempe + satrec.bstar * satrec.cc5 * (sin(mm) -
                 satrec.sinmao);
             templ = templ + satrec.t3cof * t3 + t4 * (satrec.t4cof +
-                satrec.t * satrec.t5cof);
+                state.t * satrec.t5cof);
         }
 
         nm = satrec.no_unkozai;
@@ -1839,7 +1853,7 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         inclm = satrec.inclo;
         if (satrec.method == 'd')
         {
-            tc = satrec.t;
+            tc = state.t;
             dspace
                 (
                 satrec.irez,
@@ -1849,10 +1863,10 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
                 satrec.d5433, satrec.dedt, satrec.del1,
                 satrec.del2, satrec.del3, satrec.didt,
                 satrec.dmdt, satrec.dnodt, satrec.domdt,
-                satrec.argpo, satrec.argpdot, satrec.t, tc,
+                satrec.argpo, satrec.argpdot, state.t, tc,
                 satrec.gsto, satrec.xfact, satrec.xlamo,
-                satrec.no_unkozai, satrec.atime,
-                em, argpm, inclm, satrec.xli, mm, satrec.xni,
+                satrec.no_unkozai, state.atime,
+                em, argpm, inclm, state.xli, mm, state.xni,
                 nodem, dndt, nm
                 );
         } // if method = d
@@ -1860,11 +1874,22 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         if (nm <= 0.0)
         {
             //         printf("# error nm %f\n", nm);
-            satrec.error = 2;
+            state.error = 2;
             // sgp4fix add return
             return false;
         }
-        am = pow((satrec.xke / nm), x2o3) * tempa * tempa;
+        // perturb: near earth `nm` and `inclm` are constant, so reuse these
+        if (satrec.method != 'd' && state.near_cached != 1)
+        {
+            state.near_xkepow = pow((satrec.xke / nm), x2o3);
+            // perturb: fused in fast math mode
+            hot_sincos(inclm, state.near_sinio, state.near_cosio);
+            state.near_cached = 1;
+        }
+        if (satrec.method != 'd')
+            am = state.near_xkepow * tempa * tempa;
+        else
+            am = pow((satrec.xke / nm), x2o3) * tempa * tempa;
         nm = satrec.xke / pow(am, 1.5);
         em = em - tempe;
 
@@ -1873,7 +1898,7 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         if ((em >= 1.0) || (em < -0.001)/* || (am < 0.95)*/)
         {
             //         printf("# error em %f\n", em);
-            satrec.error = 1;
+            state.error = 1;
             // sgp4fix to return if there is an error in eccentricity
             return false;
         }
@@ -1886,23 +1911,31 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         temp = 1.0 - emsq;
         (void) temp;
 
-        nodem = fmod(nodem, twopi);
-        argpm = fmod(argpm, twopi);
-        xlm = fmod(xlm, twopi);
-        mm = fmod(xlm - argpm - nodem, twopi);
+        // perturb: cheaper reductions in fast math mode
+        nodem = hot_fmod(nodem, twopi);
+        argpm = hot_fmod(argpm, twopi);
+        xlm = hot_fmod(xlm, twopi);
+        mm = hot_fmod(xlm - argpm - nodem, twopi);
 
         // sgp4fix recover singly averaged mean elements
-        satrec.am = am;
-        satrec.em = em;
-        satrec.im = inclm;
-        satrec.Om = nodem;
-        satrec.om = argpm;
-        satrec.mm = mm;
-        satrec.nm = nm;
+        state.am = am;
+        state.em = em;
+        state.im = inclm;
+        state.Om = nodem;
+        state.om = argpm;
+        state.mm = mm;
+        state.nm = nm;
 
         /* ----------------- compute extra mean quantities ------------- */
-        sinim = sin(inclm);
-        cosim = cos(inclm);
+        if (satrec.method != 'd')
+        {
+            sinim = state.near_sinio;
+            cosim = state.near_cosio;
+        }
+        else
+        {
+            hot_sincos(inclm, sinim, cosim);  // perturb: fused in fast math mode
+        }
 
         /* -------------------- add lunar-solar periodics -------------- */
         ep = em;
@@ -1922,7 +1955,7 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
                 satrec.sgh2, satrec.sgh3, satrec.sgh4,
                 satrec.sh2, satrec.sh3, satrec.si2,
                 satrec.si3, satrec.sl2, satrec.sl3,
-                satrec.sl4, satrec.t, satrec.xgh2,
+                satrec.sl4, state.t, satrec.xgh2,
                 satrec.xgh3, satrec.xgh4, satrec.xh2,
                 satrec.xh3, satrec.xi2, satrec.xi3,
                 satrec.xl2, satrec.xl3, satrec.xl4,
@@ -1938,7 +1971,7 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             if ((ep < 0.0) || (ep > 1.0))
             {
                 //            printf("# error ep %f\n", ep);
-                satrec.error = 3;
+                state.error = 3;
                 // sgp4fix add return
                 return false;
             }
@@ -1947,22 +1980,80 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         /* -------------------- long period periodics ------------------ */
         if (satrec.method == 'd')
         {
-            sinip = sin(xincp);
-            cosip = cos(xincp);
-            satrec.aycof = -0.5*satrec.j3oj2*sinip;
+            hot_sincos(xincp, sinip, cosip);  // perturb: fused in fast math mode
+            aycof = -0.5*satrec.j3oj2*sinip;
             // sgp4fix for divide by zero for xincp = 180 deg
             if (fabs(cosip + 1.0) > 1.5e-12)
-                satrec.xlcof = -0.25 * satrec.j3oj2 * sinip * (3.0 + 5.0 * cosip) / (1.0 + cosip);
+                xlcof = -0.25 * satrec.j3oj2 * sinip * (3.0 + 5.0 * cosip) / (1.0 + cosip);
             else
-                satrec.xlcof = -0.25 * satrec.j3oj2 * sinip * (3.0 + 5.0 * cosip) / temp4;
+                xlcof = -0.25 * satrec.j3oj2 * sinip * (3.0 + 5.0 * cosip) / temp4;
+            state.aycof = aycof;
+            state.xlcof = xlcof;
         }
-        axnl = ep * cos(argpp);
+        // perturb: fused in fast math mode
+        hot_sincos(argpp, sinargpp, cosargpp);
+        axnl = ep * cosargpp;
         temp = 1.0 / (am * (1.0 - ep * ep));
-        aynl = ep* sin(argpp) + temp * satrec.aycof;
-        xl = mp + argpp + nodep + temp * satrec.xlcof * axnl;
+        aynl = ep* sinargpp + temp * aycof;
+        xl = mp + argpp + nodep + temp * xlcof * axnl;
+
+        out.am = am;
+        out.nm = nm;
+        out.axnl = axnl;
+        out.aynl = aynl;
+        out.xl = xl;
+        out.xincp = xincp;
+        out.nodep = nodep;
+        out.sinip = sinip;
+        out.cosip = cosip;
+        return true;
+    }  // sgp4_long_period_core
+
+    // perturb: const core of `sgp4`, everything it changes goes in `state`.
+    // Templated so it can read from either the full or the compact record.
+    template <typename Record>
+    static bool sgp4_core
+        (
+        const Record& satrec, elsetrec_state& state, double tsince,
+        double r[3], double v[3]
+        )
+    {
+        double am, axnl, aynl, betal, cnod,
+            cos2u, coseo1, cosi, cosip, cosisq, cossu, cosu,
+            ecose, el2, eo1,
+            esine, pl, mrt = 0.0,
+            mvt, rdotl, rl, rvdot, rvdotl,
+            sin2u, sineo1, sini, sinip, sinsu, sinu,
+            snod, tem5, temp,
+            temp1, temp2, u, ux,
+            uy, uz, vx, vy, vz,
+            nm, xinc, xincp, xl,
+            xmx, xmy, xnode, nodep,
+            twopi, vkmpersec;
+        int ktr;
+        double con41 = satrec.con41, x1mth2 = satrec.x1mth2, x7thm1 = satrec.x7thm1;
+
+        twopi = 2.0 * pi;
+        // sgp4fix identify constants and allow alternate values
+        // getgravconst( whichconst, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2 );
+        vkmpersec = satrec.radiusearthkm * satrec.xke / 60.0;
+
+        // perturb: everything before the Kepler solve is split out
+        elsetrec_periodics lp;
+        if (!sgp4_long_period_core(satrec, state, tsince, lp))
+            return false;
+        am = lp.am;
+        nm = lp.nm;
+        axnl = lp.axnl;
+        aynl = lp.aynl;
+        xl = lp.xl;
+        xincp = lp.xincp;
+        nodep = lp.nodep;
+        sinip = lp.sinip;
+        cosip = lp.cosip;
 
         /* --------------------- solve kepler's equation --------------- */
-        u = fmod(xl - nodep, twopi);
+        u = hot_fmod(xl - nodep, twopi);  // perturb: cheaper in fast math mode
         eo1 = u;
         tem5 = 9999.9;
         ktr = 1;
@@ -1972,8 +2063,7 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         //   the following iteration needs better limits on corrections
         while ((fabs(tem5) >= 1.0e-12) && (ktr <= 10))
         {
-            sineo1 = sin(eo1);
-            coseo1 = cos(eo1);
+            hot_sincos(eo1, sineo1, coseo1);  // perturb: fused in fast math mode
             tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
             tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
             if (fabs(tem5) >= 0.95)
@@ -1981,6 +2071,11 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             eo1 = eo1 + tem5;
             ktr = ktr + 1;
         }
+#ifdef PERTURB_ENABLE_STATS
+        // perturb: count the iterations, and if the cap stopped them first
+        local_stats().kepler_iterations += static_cast<std::uint64_t>(ktr - 1);
+        local_stats().kepler_capped += (fabs(tem5) >= 1.0e-12) ? 1U : 0U;
+#endif
 
         /* ------------- short period preliminary quantities ----------- */
         ecose = axnl*coseo1 + aynl*sineo1;
@@ -1990,7 +2085,7 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         if (pl < 0.0)
         {
             //         printf("# error pl %f\n", pl);
-            satrec.error = 4;
+            state.error = 4;
             // sgp4fix add return
             return false;
         }
@@ -2003,7 +2098,10 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             temp = esine / (1.0 + betal);
             sinu = am / rl * (sineo1 - aynl - axnl * temp);
             cosu = am / rl * (coseo1 - axnl + aynl * temp);
-            su = atan2(sinu, cosu);
+#ifndef PERTURB_ENABLE_FAST_MATH
+            // perturb: declared here, since fast math mode doesn't need it
+            double su = atan2(sinu, cosu);
+#endif
             sin2u = (cosu + cosu) * sinu;
             cos2u = 1.0 - 2.0 * sinu * sinu;
             temp = 1.0 / pl;
@@ -2014,26 +2112,42 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
             if (satrec.method == 'd')
             {
                 cosisq = cosip * cosip;
-                satrec.con41 = 3.0*cosisq - 1.0;
-                satrec.x1mth2 = 1.0 - cosisq;
-                satrec.x7thm1 = 7.0*cosisq - 1.0;
+                con41 = 3.0*cosisq - 1.0;
+                x1mth2 = 1.0 - cosisq;
+                x7thm1 = 7.0*cosisq - 1.0;
+                state.con41 = con41;
+                state.x1mth2 = x1mth2;
+                state.x7thm1 = x7thm1;
             }
-            mrt = rl * (1.0 - 1.5 * temp2 * betal * satrec.con41) +
-                0.5 * temp1 * satrec.x1mth2 * cos2u;
-            su = su - 0.25 * temp2 * satrec.x7thm1 * sin2u;
+            mrt = rl * (1.0 - 1.5 * temp2 * betal * con41) +
+                0.5 * temp1 * x1mth2 * cos2u;
+#ifdef PERTURB_ENABLE_FAST_MATH
+            // perturb: rotate (sinu, cosu) by the correction to `su` instead of
+            // taking its angle and then the sine and cosine of that again
+            temp = 1.0 / sqrt(sinu * sinu + cosu * cosu);
+            sinu = sinu * temp;
+            cosu = cosu * temp;
+            double sindsu, cosdsu;
+            hot_sincos(-0.25 * temp2 * x7thm1 * sin2u, sindsu, cosdsu);
+            sinsu = sinu * cosdsu + cosu * sindsu;
+            cossu = cosu * cosdsu - sinu * sindsu;
+#else
+            su = su - 0.25 * temp2 * x7thm1 * sin2u;
+#endif
             xnode = nodep + 1.5 * temp2 * cosip * sin2u;
             xinc = xincp + 1.5 * temp2 * cosip * sinip * cos2u;
-            mvt = rdotl - nm * temp1 * satrec.x1mth2 * sin2u / satrec.xke;
-            rvdot = rvdotl + nm * temp1 * (satrec.x1mth2 * cos2u +
-                1.5 * satrec.con41) / satrec.xke;
+            mvt = rdotl - nm * temp1 * x1mth2 * sin2u / satrec.xke;
+            rvdot = rvdotl + nm * temp1 * (x1mth2 * cos2u +
+                1.5 * con41) / satrec.xke;
 
             /* --------------------- orientation vectors ------------------- */
+#ifndef PERTURB_ENABLE_FAST_MATH
             sinsu = sin(su);
             cossu = cos(su);
-            snod = sin(xnode);
-            cnod = cos(xnode);
-            sini = sin(xinc);
-            cosi = cos(xinc);
+#endif
+            // perturb: fused in fast math mode
+            hot_sincos(xnode, snod, cnod);
+            hot_sincos(xinc, sini, cosi);
             xmx = -snod * cosi;
             xmy = cnod * cosi;
             ux = xmx * sinsu + cnod * cossu;
@@ -2056,12 +2170,209 @@ double& rp, double& rteosq, double& sinio, double& gsto, char opsmode
         if (mrt < 1.0)
         {
             //         printf("# decay condition %11.6f \n",mrt);
-            satrec.error = 6;
+            state.error = 6;
             return false;
         }
 
         //#include "debug7.cpp"
         return true;
+    }  // sgp4_core
+
+    bool sgp4
+        (
+        const elsetrec& satrec, elsetrec_state& state, double tsince,
+        double r[3], double v[3]
+        )
+    {
+#ifdef PERTURB_ENABLE_STATS
+        // perturb: count and time every call for the stats
+        PropagationStats& stats = local_stats();
+        const StatsTimer timer(stats.propagate_nanos);
+        const bool is_valid = sgp4_core(satrec, state, tsince, r, v);
+        count_propagation(stats, state.error);
+        return is_valid;
+#else
+        return sgp4_core(satrec, state, tsince, r, v);
+#endif
+    }  // sgp4
+
+    bool sgp4
+        (
+        const elsetrec_compact& satrec, elsetrec_state& state, double tsince,
+        double r[3], double v[3]
+        )
+    {
+#ifdef PERTURB_ENABLE_STATS
+        // perturb: count and time every call for the stats
+        PropagationStats& stats = local_stats();
+        const StatsTimer timer(stats.propagate_nanos);
+        const bool is_valid = sgp4_core(satrec, state, tsince, r, v);
+        count_propagation(stats, state.error);
+        return is_valid;
+#else
+        return sgp4_core(satrec, state, tsince, r, v);
+#endif
+    }  // sgp4
+
+    bool sgp4_long_period
+        (
+        const elsetrec_compact& satrec, elsetrec_state& state, double tsince,
+        elsetrec_periodics& out
+        )
+    {
+        return sgp4_long_period_core(satrec, state, tsince, out);
+    }  // sgp4_long_period
+
+    void compact_elsetrec
+        (
+        const elsetrec& satrec, elsetrec_compact& out
+        )
+    {
+        out.jdsatepoch = satrec.jdsatepoch;
+        out.jdsatepochF = satrec.jdsatepochF;
+
+        out.mo = satrec.mo;
+        out.mdot = satrec.mdot;
+        out.argpo = satrec.argpo;
+        out.argpdot = satrec.argpdot;
+        out.nodeo = satrec.nodeo;
+        out.nodedot = satrec.nodedot;
+        out.nodecf = satrec.nodecf;
+        out.cc1 = satrec.cc1;
+        out.bstar = satrec.bstar;
+        out.cc4 = satrec.cc4;
+        out.t2cof = satrec.t2cof;
+        out.omgcof = satrec.omgcof;
+        out.eta = satrec.eta;
+        out.xmcof = satrec.xmcof;
+        out.delmo = satrec.delmo;
+        out.d2 = satrec.d2;
+        out.d3 = satrec.d3;
+        out.d4 = satrec.d4;
+        out.cc5 = satrec.cc5;
+        out.sinmao = satrec.sinmao;
+        out.t3cof = satrec.t3cof;
+        out.t4cof = satrec.t4cof;
+        out.t5cof = satrec.t5cof;
+        out.no_unkozai = satrec.no_unkozai;
+        out.ecco = satrec.ecco;
+        out.inclo = satrec.inclo;
+        out.isimp = satrec.isimp;
+        out.irez = satrec.irez;
+        out.method = satrec.method;
+        out.operationmode = satrec.operationmode;
+
+        out.d2201 = satrec.d2201;
+        out.d2211 = satrec.d2211;
+        out.d3210 = satrec.d3210;
+        out.d3222 = satrec.d3222;
+        out.d4410 = satrec.d4410;
+        out.d4422 = satrec.d4422;
+        out.d5220 = satrec.d5220;
+        out.d5232 = satrec.d5232;
+        out.d5421 = satrec.d5421;
+        out.d5433 = satrec.d5433;
+        out.dedt = satrec.dedt;
+        out.del1 = satrec.del1;
+        out.del2 = satrec.del2;
+        out.del3 = satrec.del3;
+        out.didt = satrec.didt;
+        out.dmdt = satrec.dmdt;
+        out.dnodt = satrec.dnodt;
+        out.domdt = satrec.domdt;
+        out.gsto = satrec.gsto;
+        out.xfact = satrec.xfact;
+        out.xlamo = satrec.xlamo;
+        out.e3 = satrec.e3;
+        out.ee2 = satrec.ee2;
+        out.peo = satrec.peo;
+        out.pgho = satrec.pgho;
+        out.pho = satrec.pho;
+        out.pinco = satrec.pinco;
+        out.plo = satrec.plo;
+        out.se2 = satrec.se2;
+        out.se3 = satrec.se3;
+        out.sgh2 = satrec.sgh2;
+        out.sgh3 = satrec.sgh3;
+        out.sgh4 = satrec.sgh4;
+        out.sh2 = satrec.sh2;
+        out.sh3 = satrec.sh3;
+        out.si2 = satrec.si2;
+        out.si3 = satrec.si3;
+        out.sl2 = satrec.sl2;
+        out.sl3 = satrec.sl3;
+        out.sl4 = satrec.sl4;
+        out.xgh2 = satrec.xgh2;
+        out.xgh3 = satrec.xgh3;
+        out.xgh4 = satrec.xgh4;
+        out.xh2 = satrec.xh2;
+        out.xh3 = satrec.xh3;
+        out.xi2 = satrec.xi2;
+        out.xi3 = satrec.xi3;
+        out.xl2 = satrec.xl2;
+        out.xl3 = satrec.xl3;
+        out.xl4 = satrec.xl4;
+        out.zmol = satrec.zmol;
+        out.zmos = satrec.zmos;
+
+        out.j3oj2 = satrec.j3oj2;
+        out.j2 = satrec.j2;
+        out.aycof = satrec.aycof;
+        out.xlcof = satrec.xlcof;
+        out.con41 = satrec.con41;
+        out.x1mth2 = satrec.x1mth2;
+        out.x7thm1 = satrec.x7thm1;
+        out.radiusearthkm = satrec.radiusearthkm;
+        out.xke = satrec.xke;
+    }  // compact_elsetrec
+
+    // perturb: original mutating interface, kept as a wrapper around the const core
+    bool sgp4
+        (
+        elsetrec& satrec, double tsince,
+        double r[3], double v[3]
+        )
+    {
+        elsetrec_state state;
+        state.t = satrec.t;
+        state.error = satrec.error;
+        state.atime = satrec.atime;
+        state.xli = satrec.xli;
+        state.xni = satrec.xni;
+        state.am = satrec.am;
+        state.em = satrec.em;
+        state.im = satrec.im;
+        state.Om = satrec.Om;
+        state.om = satrec.om;
+        state.mm = satrec.mm;
+        state.nm = satrec.nm;
+        state.aycof = satrec.aycof;
+        state.xlcof = satrec.xlcof;
+        state.con41 = satrec.con41;
+        state.x1mth2 = satrec.x1mth2;
+        state.x7thm1 = satrec.x7thm1;
+        state.near_cached = 0;
+
+        const bool is_valid = sgp4(satrec, state, tsince, r, v);
+
+        satrec.t = state.t;
+        satrec.error = state.error;
+        satrec.atime = state.atime;
+        satrec.xli = state.xli;
+        satrec.xni = state.xni;
+        satrec.am = state.am;
+        satrec.em = state.em;
+        satrec.im = state.im;
+        satrec.Om = state.Om;
+        satrec.om = state.om;
+        satrec.mm = state.mm;
+        satrec.nm = state.nm;
+        satrec.aycof = state.aycof;
+        satrec.xlcof = state.xlcof;
+        satrec.con41 = state.con41;
+        satrec.x1mth2 = state.x1mth2;
+        satrec.x7thm1 = state.x7thm1;
+        return is_valid;
     }  // sgp4
 
 
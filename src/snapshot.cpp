@@ -0,0 +1,173 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#ifndef PERTURB_DISABLE_IO
+
+#include "perturb/snapshot.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#include "common.hpp"
+#include "mapped_file.hpp"
+#include "perturb/sgp4.hpp"
+
+namespace perturb {
+
+// The records are written and mapped as `Satellite`s directly
+static_assert(
+    std::is_standard_layout<Satellite>::value
+        && std::is_trivially_copyable<Satellite>::value
+        && sizeof(Satellite) == sizeof(sgp4::elsetrec),
+    "Satellite must be laid out exactly like its SGP4 record"
+);
+static_assert(
+    sizeof(Satellite) % sizeof(std::uint64_t) == 0,
+    "Records are checksummed 8 bytes at a time"
+);
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = { 'P', 'T', 'R', 'B', 'S', 'N', 'A', 'P' };
+constexpr std::uint32_t SNAPSHOT_ENDIAN_TAG = 0x01020304;
+
+/// Fixed 64-byte header at the start of every snapshot file, in native byte order
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t endian_tag;
+    std::uint32_t format_version;
+    std::uint32_t record_size;
+    std::uint32_t grav_model;
+    std::uint64_t n_records;
+    std::uint64_t checksum;
+    unsigned char reserved[24];
+};
+static_assert(sizeof(SnapshotHeader) == 64, "Snapshot header must be 64 bytes");
+
+/// 64-bit FNV-1a, but over 8-byte words instead of single bytes for speed
+std::uint64_t snapshot_checksum(const char *data, const std::size_t size) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    std::uint64_t word;
+    for (std::size_t i = 0; i + sizeof(word) <= size; i += sizeof(word)) {
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// Whether a satellite was initialized with a particular gravity model
+bool uses_grav_model(const Satellite &sat, const GravModel grav_model) {
+    double tumin, mus, radiusearthkm, xke, j2, j3, j4, j3oj2;
+    sgp4::getgravconst(
+        convert_grav_model(grav_model), tumin, mus, radiusearthkm, xke, j2, j3, j4, j3oj2
+    );
+    const sgp4::elsetrec &rec = sat.sat_rec;
+    return rec.radiusearthkm == radiusearthkm && rec.xke == xke && rec.j2 == j2
+        && rec.j3 == j3 && rec.j4 == j4;
+}
+
+}  // namespace
+
+SnapshotError write_snapshot(
+    const char *path, const Satellite *sats, const std::size_t n_sats,
+    const GravModel grav_model
+) {
+    for (std::size_t i = 0; i < n_sats; ++i) {
+        if (!uses_grav_model(sats[i], grav_model)) {
+            return SnapshotError::GRAV_MODEL_MISMATCH;
+        }
+    }
+
+    const char *records = reinterpret_cast<const char *>(sats);
+    const std::size_t records_size = n_sats * sizeof(Satellite);
+    SnapshotHeader header {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.endian_tag = SNAPSHOT_ENDIAN_TAG;
+    header.format_version = SNAPSHOT_FORMAT_VERSION;
+    header.record_size = static_cast<std::uint32_t>(sizeof(Satellite));
+    header.grav_model = static_cast<std::uint32_t>(grav_model);
+    header.n_records = n_sats;
+    header.checksum = snapshot_checksum(records, records_size);
+
+    std::ofstream out_file(path, std::ios::binary | std::ios::trunc);
+    out_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out_file.write(records, static_cast<std::streamsize>(records_size));
+    out_file.close();
+    return out_file ? SnapshotError::NONE : SnapshotError::CANNOT_OPEN;
+}
+
+Snapshot::Snapshot() = default;
+
+Snapshot::~Snapshot() = default;
+
+SnapshotError Snapshot::open(
+    const char *path, const GravModel grav_model, const bool verify_checksum
+) {
+    file_.reset();
+    sats_ = nullptr;
+    size_ = 0;
+
+    std::unique_ptr<MappedFile> file(new MappedFile(path));
+    if (!file->is_open()) {
+        return SnapshotError::CANNOT_OPEN;
+    }
+    const std::size_t size = file->size();
+    if (size < sizeof(SnapshotHeader)) {
+        return SnapshotError::TRUNCATED;
+    }
+    if (std::memcmp(file->data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return SnapshotError::BAD_MAGIC;
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (header.endian_tag != SNAPSHOT_ENDIAN_TAG) {
+        return SnapshotError::ENDIAN_MISMATCH;
+    }
+    if (header.format_version != SNAPSHOT_FORMAT_VERSION
+        || header.record_size != sizeof(Satellite)) {
+        return SnapshotError::VERSION_MISMATCH;
+    }
+    if (header.grav_model != static_cast<std::uint32_t>(grav_model)) {
+        return SnapshotError::GRAV_MODEL_MISMATCH;
+    }
+    const std::size_t records_size = size - sizeof(SnapshotHeader);
+    if (header.n_records > records_size / sizeof(Satellite)) {
+        return SnapshotError::TRUNCATED;
+    }
+    const char *records = file->data() + sizeof(SnapshotHeader);
+    const auto n_records = static_cast<std::size_t>(header.n_records);
+    const std::size_t used_size = n_records * sizeof(Satellite);
+    if (verify_checksum && snapshot_checksum(records, used_size) != header.checksum) {
+        return SnapshotError::CHECKSUM_MISMATCH;
+    }
+
+    file_.swap(file);
+    sats_ = reinterpret_cast<const Satellite *>(records);
+    size_ = n_records;
+    return SnapshotError::NONE;
+}
+
+std::size_t Snapshot::size() const {
+    return size_;
+}
+
+const Satellite *Snapshot::satellites() const {
+    return sats_;
+}
+
+const Satellite &Snapshot::operator[](const std::size_t i) const {
+    return sats_[i];
+}
+
+}  // namespace perturb
+
+#endif  // PERTURB_DISABLE_IO
@@ -0,0 +1,66 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#include "perturb/stats.hpp"
+
+#include <cstddef>
+
+#include "common.hpp"
+
+namespace perturb {
+
+#ifdef PERTURB_ENABLE_STATS
+namespace {
+
+// Toolchains without threads may not have thread-local storage either
+#ifdef PERTURB_DISABLE_THREADS
+PropagationStats stats_of_thread;
+#else
+thread_local PropagationStats stats_of_thread;
+#endif
+
+}  // namespace
+
+PropagationStats &local_stats() {
+    return stats_of_thread;
+}
+#endif  // PERTURB_ENABLE_STATS
+
+PropagationStats &PropagationStats::operator+=(const PropagationStats &other) {
+    n_inits += other.n_inits;
+    init_nanos += other.init_nanos;
+    n_propagations += other.n_propagations;
+    propagate_nanos += other.propagate_nanos;
+    dspace_steps += other.dspace_steps;
+    kepler_iterations += other.kepler_iterations;
+    kepler_capped += other.kepler_capped;
+    lyddane += other.lyddane;
+    for (std::size_t k = 0; k < N_SGP4_ERRORS; ++k) {
+        errors[k] += other.errors[k];
+    }
+    return *this;
+}
+
+PropagationStats thread_stats() {
+#ifdef PERTURB_ENABLE_STATS
+    return local_stats();
+#else
+    return PropagationStats();
+#endif
+}
+
+void reset_thread_stats() {
+#ifdef PERTURB_ENABLE_STATS
+    local_stats() = PropagationStats();
+#endif
+}
+
+}  // namespace perturb
@@ -12,20 +12,24 @@
 #include "perturb/tle.hpp"
 
 #include <array>
-#ifndef PERTURB_DISABLE_IO
-#  include <cctype>
-#  include <cmath>
-#  include <cstdio>
-#  include <cstring>
-#endif
+#include <cmath>
+#include <cstring>
 
 namespace perturb {
 
-#ifndef PERTURB_DISABLE_IO
-static unsigned int calc_tle_line_checksum(const char *line) {
+namespace {
+
+constexpr double POW_10[] = { 1e0, 1e1, 1e2, 1e3, 1e4,  1e5,  1e6,
+                              1e7, 1e8, 1e9, 1e10, 1e11, 1e12 };
+
+bool is_digit(const char c) {
+    return ('0' <= c) && (c <= '9');
+}
+
+unsigned int calc_tle_line_checksum(const char *line) {
     unsigned int checksum = 0U;
     for (std::size_t i = 0; i < (TLE_LINE_LEN - 1); ++i) {
-        if (std::isdigit(line[i])) {
+        if (is_digit(line[i])) {
             checksum += static_cast<unsigned int>(line[i] - '0');
         }
         if (line[i] == '-') {
@@ -34,11 +38,111 @@ static unsigned int calc_tle_line_checksum(const char *line) {
     }
     return (checksum % 10U);
 }
-#endif  // PERTURB_DISABLE_IO
 
-#ifndef PERTURB_DISABLE_IO
-// FIXME: Use a more robust parsing method. I wish string_view existed :(
-TLEParseError TwoLineElement::parse(const char *line_1, const char *line_2) {
+// Each field parser reads exactly the columns `[begin, end)` of a line, where
+// leading spaces are skipped but any other character out of place is an error.
+
+/// Parse an unsigned integer, where a blank field is only allowed if `blank_ok`
+bool parse_uint(
+    const char *line, std::size_t begin, const std::size_t end, unsigned long &out,
+    const bool blank_ok = false
+) {
+    while (begin < end && line[begin] == ' ') {
+        ++begin;
+    }
+    unsigned long value = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        if (!is_digit(line[i])) {
+            return false;
+        }
+        value = value * 10U + static_cast<unsigned long>(line[i] - '0');
+    }
+    out = value;
+    return blank_ok || (begin < end);
+}
+
+/// Parse a signed integer with an optional `+` or `-` sign
+bool parse_int(const char *line, std::size_t begin, const std::size_t end, int &out) {
+    while (begin < end && line[begin] == ' ') {
+        ++begin;
+    }
+    const bool negative = (begin < end) && (line[begin] == '-');
+    if (begin < end && (line[begin] == '-' || line[begin] == '+')) {
+        ++begin;
+    }
+    unsigned long value;
+    if (!parse_uint(line, begin, end, value)) {
+        return false;
+    }
+    out = negative ? -static_cast<int>(value) : static_cast<int>(value);
+    return true;
+}
+
+/// Parse a decimal number with an optional sign and decimal point.
+///
+/// All the digits are accumulated into one integer, which is then divided
+/// by the right power of 10. Both of those are exactly representable for the
+/// at most 12 digits that fit in a TLE field, so the division is correctly
+/// rounded, giving the exact same result as `strtod`. Trailing spaces are
+/// allowed since some fields have padding.
+bool parse_decimal(const char *line, std::size_t begin, std::size_t end, double &out) {
+    while (begin < end && line[begin] == ' ') {
+        ++begin;
+    }
+    while (begin < end && line[end - 1] == ' ') {
+        --end;
+    }
+    const bool negative = (begin < end) && (line[begin] == '-');
+    if (begin < end && (line[begin] == '-' || line[begin] == '+')) {
+        ++begin;
+    }
+    unsigned long long digits = 0;
+    std::size_t n_digits = 0, n_frac_digits = 0;
+    bool seen_point = false;
+    for (std::size_t i = begin; i < end; ++i) {
+        const char c = line[i];
+        if (c == '.' && !seen_point) {
+            seen_point = true;
+        } else if (is_digit(c)) {
+            digits = digits * 10U + static_cast<unsigned long long>(c - '0');
+            ++n_digits;
+            n_frac_digits += seen_point ? 1U : 0U;
+        } else {
+            return false;
+        }
+    }
+    if (n_digits == 0 || n_digits >= sizeof(POW_10) / sizeof(POW_10[0])) {
+        return false;
+    }
+    const double value = static_cast<double>(digits) / POW_10[n_frac_digits];
+    out = negative ? -value : value;
+    return true;
+}
+
+/// Copy a text field without its leading and trailing spaces, which can't
+/// have any spaces in the middle
+bool parse_text(const char *line, std::size_t begin, std::size_t end, char *out) {
+    while (begin < end && line[begin] == ' ') {
+        ++begin;
+    }
+    while (begin < end && line[end - 1] == ' ') {
+        --end;
+    }
+    std::memcpy(out, line + begin, end - begin);
+    out[end - begin] = '\0';
+    return std::memchr(out, ' ', end - begin) == nullptr;
+}
+
+}  // namespace
+
+TLEParseError TwoLineElement::parse(
+    const char *line_1, const std::size_t len_1, const char *line_2,
+    const std::size_t len_2
+) {
+    if (len_1 < TLE_LINE_LEN || len_2 < TLE_LINE_LEN) {
+        return TLEParseError::INVALID_FORMAT;
+    }
+
     // Make sure there are spaces in the right places
     constexpr std::array<int, 8> LINE_1_SPACES = { 2, 9, 18, 33, 44, 53, 62, 64 };
     for (const int i : LINE_1_SPACES) {
@@ -53,73 +157,54 @@ TLEParseError TwoLineElement::parse(const char *line_1, const char *line_2) {
         }
     }
 
-    // Parse format
+    // Parse format, with every field at its fixed columns. The international
+    // designator and ephemeris type are often left blank, so those are allowed.
+    // The exponent of `n_ddot` and `b_star` is implied to come after a leading
+    // decimal point, unless the point is written out explicitly.
+    bool valid_format = true;
+    unsigned long line1_num = 0, line2_num = 0, uint_val = 0;
+    int n_ddot_exp = 0, b_star_exp = 0;
+    char catalog_number_line2[6];
 
     // Line 1
-    constexpr auto LINE_1_FMT_STR =
-        "%1hhu %5s %1c %2u %3u %3s %2u %12lf %10lf %6lf %2d %6lf %2d %1hhu %4u %n %1hhu";
-    unsigned char line1_num;
-    int n_ddot_exp, b_star_exp, l1_pre_checksum;
-    int l1_scanned = std::sscanf(  // Brooo C++ sucks at string processing :(
-        line_1, LINE_1_FMT_STR, &line1_num, this->catalog_number, &this->classification,
-        &this->launch_year, &this->launch_number, this->launch_piece, &this->epoch_year,
-        &this->epoch_day_of_year, &this->n_dot, &this->n_ddot, &n_ddot_exp,
-        &this->b_star, &b_star_exp, &this->ephemeris_type, &this->element_set_number,
-        &l1_pre_checksum, &this->line_1_checksum
-    );
+    valid_format &= parse_uint(line_1, 0, 1, line1_num);
+    valid_format &= parse_text(line_1, 2, 7, this->catalog_number);
+    valid_format &= (this->catalog_number[0] != '\0');
+    this->classification = line_1[7];
+    valid_format &= parse_uint(line_1, 9, 11, uint_val, true);
+    this->launch_year = static_cast<unsigned int>(uint_val);
+    valid_format &= parse_uint(line_1, 11, 14, uint_val, true);
+    this->launch_number = static_cast<unsigned int>(uint_val);
+    valid_format &= parse_text(line_1, 14, 17, this->launch_piece);
+    valid_format &= parse_uint(line_1, 18, 20, uint_val);
+    this->epoch_year = static_cast<unsigned int>(uint_val);
+    valid_format &= parse_decimal(line_1, 20, 32, this->epoch_day_of_year);
+    valid_format &= parse_decimal(line_1, 33, 43, this->n_dot);
+    valid_format &= parse_decimal(line_1, 44, 50, this->n_ddot);
+    valid_format &= parse_int(line_1, 50, 52, n_ddot_exp);
+    valid_format &= parse_decimal(line_1, 53, 59, this->b_star);
+    valid_format &= parse_int(line_1, 59, 61, b_star_exp);
+    valid_format &= parse_uint(line_1, 62, 63, uint_val, true);
+    this->ephemeris_type = static_cast<unsigned char>(uint_val);
+    valid_format &= parse_uint(line_1, 64, 68, uint_val, true);
+    this->element_set_number = static_cast<unsigned int>(uint_val);
+    valid_format &= parse_uint(line_1, 68, 69, uint_val);
+    this->line_1_checksum = static_cast<unsigned char>(uint_val);
 
     // Line 2
-    constexpr auto LINE_2_FMT_STR_NO_SPACE =
-        "%1hhu %5s %8lf %8lf %7lu %8lf %8lf %11lf %5lu %n %1hhu";
-    constexpr auto LINE_2_FMT_STR_WT_SPACE =
-        "%1hhu %5s %8lf %8lf %7lu %8lf %8lf %10lf %5lu %n %1hhu";
-    unsigned char line2_num;
-    char catlog_num_line2[6];
-    unsigned long eccentricity_int;
-    int l2_scanned, l2_pre_checksum;
-    // :( Yeah, I know, this is annoying...
-    if (line_2[52] != ' ') {
-        l2_scanned = std::sscanf(
-            line_2, LINE_2_FMT_STR_NO_SPACE, &line2_num, catlog_num_line2,
-            &this->inclination, &this->raan, &eccentricity_int, &this->arg_of_perigee,
-            &this->mean_anomaly, &this->mean_motion, &this->revolution_number,
-            &l2_pre_checksum, &this->line_2_checksum
-        );
-    } else {
-        l2_scanned = std::sscanf(
-            line_2, LINE_2_FMT_STR_WT_SPACE, &line2_num, catlog_num_line2,
-            &this->inclination, &this->raan, &eccentricity_int, &this->arg_of_perigee,
-            &this->mean_anomaly, &this->mean_motion, &this->revolution_number,
-            &l2_pre_checksum, &this->line_2_checksum
-        );
-    }
-
-    this->catalog_number[5] = '\0';
-    this->launch_piece[3] = '\0';
-    catlog_num_line2[5] = '\0';
-
-    // Handle some annoying special cases
-    const bool fix_l1_checksum = (l1_scanned == 15)
-        && (l1_pre_checksum >= static_cast<int>(TLE_LINE_LEN))
-        && (line_1[TLE_LINE_LEN - 5] == ' ');
-    if (fix_l1_checksum) {
-        // Element set number often doesn't have leading zeroes,
-        // so `sscanf` over-consumes and eats up the final checksum.
-        this->element_set_number /= 10U;  // Chop of least-significant digit
-        this->line_1_checksum =
-            static_cast<unsigned char>(line_1[TLE_LINE_LEN - 1] - '0');
-        l1_scanned += 1;
-    }
-    const bool fix_l2_checksum = (l2_scanned == 9)
-        && (l2_pre_checksum >= static_cast<int>(TLE_LINE_LEN))
-        && (line_2[TLE_LINE_LEN - 6] == ' ');
-    if (fix_l2_checksum) {
-        // If revolution number doens't have leading zero, so same issue as above
-        this->revolution_number /= 10U;
-        this->line_2_checksum =
-            static_cast<unsigned char>(line_2[TLE_LINE_LEN - 1] - '0');
-        l2_scanned += 1;
-    }
+    unsigned long eccentricity_int = 0;
+    valid_format &= parse_uint(line_2, 0, 1, line2_num);
+    valid_format &= parse_text(line_2, 2, 7, catalog_number_line2);
+    valid_format &= parse_decimal(line_2, 8, 16, this->inclination);
+    valid_format &= parse_decimal(line_2, 17, 25, this->raan);
+    valid_format &= parse_uint(line_2, 26, 33, eccentricity_int);
+    valid_format &= parse_decimal(line_2, 34, 42, this->arg_of_perigee);
+    valid_format &= parse_decimal(line_2, 43, 51, this->mean_anomaly);
+    valid_format &= parse_decimal(line_2, 52, 63, this->mean_motion);
+    valid_format &= parse_uint(line_2, 63, 68, this->revolution_number, true);
+    valid_format &= parse_uint(line_2, 68, 69, uint_val);
+    this->line_2_checksum = static_cast<unsigned char>(uint_val);
+
     if (line_1[44] != '.') {
         n_ddot_exp -= 5;
     }
@@ -127,8 +212,8 @@ TLEParseError TwoLineElement::parse(const char *line_1, const char *line_2) {
         b_star_exp -= 5;
     }
 
-    // Check that the correct number of values were parsed
-    if (l1_scanned != 16 || l2_scanned != 10) {
+    // Check that every field was parsed
+    if (!valid_format) {
         return TLEParseError::INVALID_FORMAT;
     }
 
@@ -151,8 +236,7 @@ TLEParseError TwoLineElement::parse(const char *line_1, const char *line_2) {
     valid_vals &= (this->element_set_number < 10000U);
     // Line 2
     valid_vals &= (line2_num == 2);
-    // FIXME: Change to `strncmp`
-    valid_vals &= (std::strcmp(this->catalog_number, catlog_num_line2) == 0);
+    valid_vals &= (std::strcmp(this->catalog_number, catalog_number_line2) == 0);
     valid_vals &= (0.0 <= this->inclination) && (this->inclination <= 180.0);
     valid_vals &= (0.0 <= this->raan) && (this->raan <= 360.0);
     valid_vals &= (0.0 <= this->arg_of_perigee) && (this->arg_of_perigee <= 360.0);
@@ -171,16 +255,19 @@ TLEParseError TwoLineElement::parse(const char *line_1, const char *line_2) {
 
     return TLEParseError::NONE;
 }
-#endif  // PERTURB_DISABLE_IO
+
+TLEParseError TwoLineElement::parse(const char *line_1, const char *line_2) {
+    // Stop at the null terminator of a short line instead of reading past it
+    return this->parse(
+        line_1, strnlen(line_1, TLE_LINE_LEN), line_2, strnlen(line_2, TLE_LINE_LEN)
+    );
+}
 
 #ifndef PERTURB_DISABLE_IO
 TLEParseError TwoLineElement::parse(
     const std::string &line_1, const std::string &line_2
 ) {
-    if (line_1.length() < TLE_LINE_LEN || line_2.length() < TLE_LINE_LEN) {
-        return TLEParseError::INVALID_FORMAT;
-    }
-    return this->parse(line_1.c_str(), line_2.c_str());
+    return this->parse(line_1.data(), line_1.length(), line_2.data(), line_2.length());
 }
 #endif  // PERTURB_DISABLE_IO
 
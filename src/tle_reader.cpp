@@ -0,0 +1,177 @@
+/*
+ * perturb -- A modern C++11 wrapper for the SGP4 orbit propagator
+ * Version 1.0.0
+ * https://github.com/gunvirranu/perturb
+ *
+ * Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2022 Gunvir Ranu
+ */
+
+#ifndef PERTURB_DISABLE_IO
+
+#include "perturb/tle_reader.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+#include "common.hpp"
+#include "mapped_file.hpp"
+#include "perturb/catalog.hpp"
+
+namespace perturb {
+
+namespace {
+
+bool starts_with(const char *line, const std::size_t len, const char c) {
+    return len >= 2 && line[0] == c && line[1] == ' ';
+}
+
+}  // namespace
+
+TleReader::TleReader(const char *path) : file_(new MappedFile(path)) {
+    data_ = file_->data();
+    size_ = file_->size();
+    is_open_ = file_->is_open();
+    find_records();
+}
+
+TleReader::TleReader(const char *data, const std::size_t size)
+    : data_(data), size_(size), is_open_(true) {
+    find_records();
+}
+
+TleReader::~TleReader() = default;
+
+bool TleReader::is_open() const {
+    return is_open_;
+}
+
+std::size_t TleReader::size() const {
+    return records_.size();
+}
+
+void TleReader::find_records() {
+    // A bit less than one record per 2 lines, so a decent guess to start with
+    records_.reserve(size_ / (2 * (TLE_LINE_LEN + 1)) + 1);
+
+    const char *name = nullptr;
+    std::size_t name_len = 0;
+    bool pending = false;  // If the last record is still waiting for its second line
+
+    const char *pos = data_;
+    const char *const end = data_ + size_;
+    for (std::size_t line_number = 1; pos < end; ++line_number) {
+        const char *line = pos;
+        const auto remaining = static_cast<std::size_t>(end - pos);
+        const void *newline = std::memchr(pos, '\n', remaining);
+        const char *line_end = newline ? static_cast<const char *>(newline) : end;
+        pos = line_end + 1;
+        if (line_end > line && line_end[-1] == '\r') {
+            --line_end;
+        }
+        const auto len = static_cast<std::size_t>(line_end - line);
+
+        if (pending) {
+            pending = false;
+            if (starts_with(line, len, '2')) {
+                records_.back().line_2 = line;
+                records_.back().len_2 = len;
+                continue;
+            }
+            // Otherwise leave it without a second line, so it fails to parse
+        }
+        if (len == 0 || line[0] == '#') {
+            name = nullptr;
+            continue;
+        }
+        if (starts_with(line, len, '1') || starts_with(line, len, '2')) {
+            // A stray second line also gets reported, but without a first line
+            pending = (line[0] == '1');
+            Record rec {};
+            rec.line_number = line_number;
+            rec.name = pending ? name : nullptr;
+            rec.name_len = pending ? name_len : 0;
+            rec.line_1 = pending ? line : nullptr;
+            rec.len_1 = pending ? len : 0;
+            records_.push_back(rec);
+            name = nullptr;
+            continue;
+        }
+        // Anything else is the name line of the next TLE
+        name = line;
+        name_len = len;
+        if (starts_with(name, name_len, '0')) {
+            name += 2;
+            name_len -= 2;
+        }
+        while (name_len > 0 && name[name_len - 1] == ' ') {
+            --name_len;
+        }
+    }
+}
+
+std::size_t TleReader::read(
+    std::vector<Satellite> &out_sats, std::vector<TleReadResult> &out_results,
+    const GravModel grav_model, const std::size_t n_threads
+) const {
+    const std::size_t n_loaded_before = out_sats.size();
+    // Small enough to balance the work, big enough to not contend
+    constexpr std::size_t PARSE_BLOCK_RECORDS = 256;
+
+    out_results.assign(records_.size(), TleReadResult {});
+    std::vector<TwoLineElement> tles(records_.size());
+    parallel_for_blocks(
+        records_.size(), PARSE_BLOCK_RECORDS, n_threads,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const Record &rec = records_[i];
+                TleReadResult &result = out_results[i];
+                result.line_number = rec.line_number;
+                if (rec.name != nullptr) {
+                    result.name.assign(rec.name, rec.name_len);
+                }
+                result.parse_error =
+                    tles[i].parse(rec.line_1, rec.len_1, rec.line_2, rec.len_2);
+                result.init_error = Sgp4Error::INVALID_TLE;
+                result.sat_index = TLE_NOT_LOADED;
+            }
+        }
+    );
+
+    // Initialize only the parsed TLEs, packed together
+    std::vector<std::size_t> parsed_idx;
+    std::size_t n_parsed = 0;
+    for (std::size_t i = 0; i < records_.size(); ++i) {
+        if (out_results[i].parse_error == TLEParseError::NONE) {
+            tles[n_parsed++] = tles[i];
+            parsed_idx.push_back(i);
+        }
+    }
+    std::vector<Sgp4Error> init_errors(n_parsed);
+    (void) init_satellites(
+        tles.data(), n_parsed, out_sats, init_errors.data(), grav_model, n_threads
+    );
+
+    // Pack the successfully initialized satellites down over the failed ones
+    std::size_t n_loaded = n_loaded_before;
+    for (std::size_t k = 0; k < n_parsed; ++k) {
+        TleReadResult &result = out_results[parsed_idx[k]];
+        result.init_error = init_errors[k];
+        if (result.init_error == Sgp4Error::NONE) {
+            if (n_loaded != n_loaded_before + k) {
+                out_sats[n_loaded] = out_sats[n_loaded_before + k];
+            }
+            result.sat_index = n_loaded++;
+        }
+    }
+    out_sats.erase(
+        out_sats.begin() + static_cast<std::ptrdiff_t>(n_loaded), out_sats.end()
+    );
+    return records_.size() - (n_loaded - n_loaded_before);
+}
+
+}  // namespace perturb
+
+#endif  // PERTURB_DISABLE_IO
@@ -0,0 +1,94 @@
+// Generates `generated-reference.out`, the baseline `test_sgp4_reference` compares
+// against, by running every case of `SGP4-VER.TLE` through the unmodified
+// source in `original/`. The loop follows the verification mode of Vallado's
+// `testcpp` driver, with the AFSPC operation mode and WGS72.
+//
+// It isn't part of the build, since the original source doesn't compile cleanly
+// with the project's warnings. From the repo root:
+//
+//     c++ -O2 -Ioriginal -o gen_ref original/SGP4.cpp tests/generate_reference.cpp
+//     ./gen_ref tests/SGP4-VER.TLE tests/generated-reference.out
+
+#include <cmath>
+#include <cstdio>
+
+#include "SGP4.h"
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s TLE_FILE OUT_FILE\n", argv[0]);
+        return 1;
+    }
+    FILE *in_file = std::fopen(argv[1], "r");
+    FILE *out_file = std::fopen(argv[2], "w");
+    if (in_file == nullptr || out_file == nullptr) {
+        std::fprintf(stderr, "Couldn't open the input or output file\n");
+        return 1;
+    }
+
+    constexpr double RAD_TO_DEG = 180.0 / 3.14159265358979323846;
+    char line_1[130], line_2[130];
+    double startmfe, stopmfe, deltamin, r[3], v[3];
+    elsetrec satrec;
+    while (std::fgets(line_1, sizeof(line_1), in_file) != nullptr) {
+        if (line_1[0] == '#') {
+            continue;
+        }
+        if (std::fgets(line_2, sizeof(line_2), in_file) == nullptr) {
+            break;
+        }
+        SGP4Funcs::twoline2rv(
+            line_1, line_2, 'v', 'e', 'a', wgs72, startmfe, stopmfe, deltamin, satrec
+        );
+        std::fprintf(out_file, "%s xx\n", satrec.satnum);
+
+        // When initialization fails this prints leftovers from the previous case,
+        // as the driver does, which is why the test skips the first row
+        SGP4Funcs::sgp4(satrec, 0.0, r, v);
+        std::fprintf(
+            out_file, " %16.8f %16.8f %16.8f %16.8f %12.9f %12.9f %12.9f\n", satrec.t,
+            r[0], r[1], r[2], v[0], v[1], v[2]
+        );
+
+        double tsince = startmfe;
+        if (std::fabs(tsince) > 1.0e-8) {
+            tsince -= deltamin;
+        }
+        while (tsince < stopmfe && satrec.error == 0) {
+            tsince = std::fmin(tsince + deltamin, stopmfe);
+            SGP4Funcs::sgp4(satrec, tsince, r, v);
+            if (satrec.error > 0) {
+                std::printf(
+                    "# *** error: t:= %f *** code = %3d\n", satrec.t, satrec.error
+                );
+                continue;
+            }
+            double jd = satrec.jdsatepoch;
+            double jd_frac = satrec.jdsatepochF + tsince / 1440.0;
+            if (jd_frac < 0.0) {
+                jd -= 1.0;
+                jd_frac += 1.0;
+            }
+            int year, mon, day, hr, min;
+            double sec;
+            SGP4Funcs::invjday_SGP4(jd, jd_frac, year, mon, day, hr, min, sec);
+            double p, a, ecc, incl, node, argp, nu, m, arglat, truelon, lonper;
+            SGP4Funcs::rv2coe_SGP4(
+                r, v, satrec.mus, p, a, ecc, incl, node, argp, nu, m, arglat, truelon,
+                lonper
+            );
+            std::fprintf(
+                out_file,
+                " %16.8f %16.8f %16.8f %16.8f %12.9f %12.9f %12.9f"
+                " %14.6f %8.6f %10.5f %10.5f %10.5f %10.5f %10.5f"
+                " %5i%3i%3i %2i:%2i:%9.6f\n",
+                tsince, r[0], r[1], r[2], v[0], v[1], v[2], a, ecc, incl * RAD_TO_DEG,
+                node * RAD_TO_DEG, argp * RAD_TO_DEG, nu * RAD_TO_DEG,
+                m * RAD_TO_DEG, year, mon, day, hr, min, sec
+            );
+        }
+    }
+    std::fclose(in_file);
+    std::fclose(out_file);
+    return 0;
+}
@@ -3,11 +3,28 @@
 #include <doctest/doctest.h>
 
 #include <array>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "perturb/catalog.hpp"
+#include "perturb/conjunction.hpp"
+#include "perturb/ephemeris.hpp"
+#include "perturb/frames.hpp"
+#include "perturb/observer.hpp"
+#include "perturb/parallel.hpp"
 #include "perturb/perturb.hpp"
+#include "perturb/snapshot.hpp"
+#include "perturb/stats.hpp"
 #include "perturb/tle.hpp"
+#include "perturb/tle_reader.hpp"
 
 using namespace perturb;
 
@@ -22,6 +39,37 @@ double norm(const Vec3 &v) {
     return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
 }
 
+/// Distance between two vectors, relative to the length of the second
+double relative_error(const Vec3 &a, const Vec3 &b) {
+    const Vec3 d = { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+    return norm(d) / norm(b);
+}
+
+// Scalar SGP4 stops its Kepler iterations within 1e-12 rad, and the catalog's
+// batched solver converges further, so they only agree to around that
+constexpr double CATALOG_REL_TOLERANCE = 1e-11;
+
+#ifndef PERTURB_DISABLE_IO
+/// Load every satellite from the verification TLEs using the standard TLE length
+std::vector<Satellite> load_verif_sats(const GravModel grav_model = GravModel::WGS72) {
+    std::ifstream in_file("SGP4-VER.TLE");
+    REQUIRE_MESSAGE(in_file, "Ensure verification data file exists and is opened");
+
+    std::vector<Satellite> sats;
+    std::string line_1, line_2;
+    while (std::getline(in_file, line_1)) {
+        if (line_1[0] == '#') {
+            continue;
+        }
+        REQUIRE(std::getline(in_file, line_2));
+        line_1.resize(TLE_LINE_LEN);
+        line_2.resize(TLE_LINE_LEN);
+        sats.push_back(Satellite::from_tle(line_1, line_2, grav_model));
+    }
+    return sats;
+}
+#endif  // PERTURB_DISABLE_IO
+
 // Verification mode TLE parsing is excluded by default
 #ifdef PERTURB_SGP4_ENABLE_DEBUG
 /// Construct a `Satellite` from special extended verification mode ('v') TLEs
@@ -128,7 +176,6 @@ TEST_CASE(
     }
 }
 
-#ifndef PERTURB_DISABLE_IO
 TEST_CASE("test_tle_parse") {
     const char *TLE_1 =
         "1 25544U 98067A   22071.78032407  .00021395  00000-0  39008-3 0  9996";
@@ -219,8 +266,108 @@ TEST_CASE("test_tle_parse") {
         );
         CHECK(err3 == TLEParseError::INVALID_FORMAT);
     }
+
+    SUBCASE("test_line_views") {
+        // Lines pointing into a larger buffer, without null terminators
+        char buf[2 * TLE_LINE_LEN];
+        std::memcpy(buf, TLE_1, TLE_LINE_LEN);
+        std::memcpy(buf + TLE_LINE_LEN, TLE_2, TLE_LINE_LEN);
+
+        TwoLineElement tle {}, tle_ref {};
+        REQUIRE(tle_ref.parse(TLE_1, TLE_2) == TLEParseError::NONE);
+        const auto err1 =
+            tle.parse(buf, TLE_LINE_LEN, buf + TLE_LINE_LEN, TLE_LINE_LEN);
+        CHECK(err1 == TLEParseError::NONE);
+        CHECK(tle.catalog_number == "25544");
+        CHECK(tle.epoch_day_of_year == tle_ref.epoch_day_of_year);
+        CHECK(tle.b_star == tle_ref.b_star);
+        CHECK(tle.mean_motion == tle_ref.mean_motion);
+        CHECK(tle.line_2_checksum == tle_ref.line_2_checksum);
+
+        // Too short, even though the memory is there
+        const auto err2 =
+            tle.parse(buf, TLE_LINE_LEN - 1, buf + TLE_LINE_LEN, TLE_LINE_LEN);
+        CHECK(err2 == TLEParseError::INVALID_FORMAT);
+    }
+
+    SUBCASE("test_blank_and_signed_fields") {
+        TwoLineElement tle {};
+        const auto err1 = tle.parse(
+            "1 11801U          80230.29629788  .01431103  00000-0  14311-1      13",
+            "2 11801  46.7916 230.4354 7318036  47.4722  10.4117  2.28537848    13"
+        );
+        CHECK(err1 == TLEParseError::NONE);
+        CHECK(tle.launch_year == 0U);
+        CHECK(tle.launch_number == 0U);
+        CHECK(tle.launch_piece == "");
+        CHECK(tle.ephemeris_type == 0U);
+        CHECK(tle.element_set_number == 1U);
+        CHECK(tle.b_star == Approx(0.14311e-1).epsilon(1e-15));
+        CHECK(tle.eccentricity == 0.7318036);
+        CHECK(tle.revolution_number == 1UL);
+
+        const auto err2 = tle.parse(
+            "1 23599U 95029B   06171.76535463  .00085586  12891-6  12956-2 0  2905",
+            "2 23599   6.9327   0.2849 5782022 274.4436  25.2425  4.47796565123555"
+        );
+        CHECK(err2 == TLEParseError::NONE);
+        CHECK(tle.n_ddot == Approx(0.12891e-6).epsilon(1e-15));
+
+        const auto err3 = tle.parse(
+            "1 28350U 04020A   06167.21788666  .16154492  76267-5  18678-3 0  8894",
+            "2 28350  64.9977 345.6130 0024870 260.7578  99.9590 16.47856722116490"
+        );
+        CHECK(err3 == TLEParseError::NONE);
+        CHECK(tle.n_dot == 0.16154492);
+
+        const auto err4 = tle.parse(
+            "1 04632U 70093B   04031.91070959 -.00000084  00000-0  10000-3 0  9955",
+            "2 04632  11.4628 273.1101 1450506 207.6000 143.9350  1.20231981 44145"
+        );
+        CHECK(err4 == TLEParseError::NONE);
+        CHECK(tle.n_dot == -0.00000084);
+        CHECK(tle.mean_motion == 1.20231981);
+    }
+
+    SUBCASE("test_format_errors") {
+        TwoLineElement tle {};
+        // Space in the middle of a number
+        const auto err1 = tle.parse(
+            "1 25544U 98067A   22071.78032407  .00021395  00000-0  39 08-3 0  9996",
+            TLE_2
+        );
+        CHECK(err1 == TLEParseError::INVALID_FORMAT);
+
+        // Two decimal points
+        const auto err2 = tle.parse(
+            TLE_1,
+            "2 25544  51.6424  94.0370 0004047 256.5103  89.8846 15.4938.383330227"
+        );
+        CHECK(err2 == TLEParseError::INVALID_FORMAT);
+
+        // Sign in the implied-decimal eccentricity
+        const auto err3 = tle.parse(
+            TLE_1,
+            "2 25544  51.6424  94.0370 -004047 256.5103  89.8846 15.49386383330227"
+        );
+        CHECK(err3 == TLEParseError::INVALID_FORMAT);
+
+        // Format errors take priority over invalid values and checksums
+        const auto err4 = tle.parse(
+            "3 25544X 98067A   22071.78032407  .00021395  00000-0  39008-3 0  999*",
+            TLE_2
+        );
+        CHECK(err4 == TLEParseError::INVALID_FORMAT);
+
+        // C-strings that end before the last column
+        const auto err5 = tle.parse(
+            "1 25544U 98067A   22071.78032407  .00021395  00000-0  39008-3 0  99", TLE_2
+        );
+        CHECK(err5 == TLEParseError::INVALID_FORMAT);
+        const auto err6 = tle.parse(TLE_1, "");
+        CHECK(err6 == TLEParseError::INVALID_FORMAT);
+    }
 }
-#endif  // PERTURB_DISABLE_IO
 
 #ifndef PERTURB_DISABLE_IO
 TEST_CASE(
@@ -332,7 +479,7 @@ TEST_CASE(
     constexpr double RAD_TO_DEG = 180 / PI;
     constexpr double DEG_TO_RAD = PI / 180;
 
-    // TODO: Figure out how to actually compare against `tcppver.out`
+    // Only writes the output, `test_sgp4_reference` compares against the baseline
     std::ifstream in_file("SGP4-VER.TLE");
     REQUIRE_MESSAGE(in_file, "Ensure verification data file exists and is opened");
 
@@ -456,6 +603,151 @@ TEST_CASE(
     }
     std::fclose(out_file);
 }
+
+/// Most a verification case can differ from the reference output
+struct ReferenceTolerance {
+    const char *satnum;
+    double position;  ///< Position difference in [km]
+    double velocity;  ///< Velocity difference in [km/s]
+};
+
+/// The reference is printed to 1e-8 km and 1e-9 km/s, which this leaves room for
+constexpr ReferenceTolerance DEFAULT_REFERENCE_TOLERANCE = { "", 1e-7, 1e-9 };
+
+/// Cases allowed to differ by more than the default, none so far. If a change
+/// makes a case stray further, loosen it here and say why.
+const std::vector<ReferenceTolerance> REFERENCE_TOLERANCES = {};
+
+/// Rows of one case of the reference output: time, position, and velocity
+struct ReferenceCase {
+    std::string satnum;
+    std::vector<std::array<double, 7>> rows;
+};
+
+/// Read every case from the reference output (`generated-reference.out`).
+///
+/// This is a baseline regenerated by `generate_reference.cpp`, which runs
+/// `SGP4-VER.TLE` through the unmodified source in `original/` the way
+/// Vallado's `testcpp` driver does, in verification mode with the AFSPC
+/// operation mode and WGS72. So it checks this tree against the original code,
+/// not against an independently published output. Error messages only go to
+/// the console, so a case that errors just stops early.
+std::vector<ReferenceCase> read_reference(std::ifstream &in_file) {
+    std::vector<ReferenceCase> cases;
+    std::string line;
+    while (std::getline(in_file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream stream(line);
+        if (line.find("xx") != std::string::npos) {
+            cases.push_back(ReferenceCase());
+            stream >> cases.back().satnum;
+            continue;
+        }
+        std::array<double, 7> row {};
+        for (auto &x : row) {
+            stream >> x;
+        }
+        REQUIRE(!stream.fail());
+        REQUIRE(!cases.empty());
+        cases.back().rows.push_back(row);
+    }
+    return cases;
+}
+
+TEST_CASE(
+    "test_sgp4_reference"
+    * doctest::description("Compare every verification case against the original SGP4")
+) {
+    std::ifstream tle_file("SGP4-VER.TLE");
+    REQUIRE_MESSAGE(tle_file, "Ensure verification data file exists and is opened");
+    std::ifstream ref_file("generated-reference.out");
+    REQUIRE_MESSAGE(ref_file, "Ensure reference output file exists and is opened");
+    const auto ref_cases = read_reference(ref_file);
+
+    // Errors and timings of each case, to track accuracy alongside performance
+    FILE *report = std::fopen("sgp4-reference-report.json", "w");
+    REQUIRE(report != nullptr);
+    std::fprintf(report, "[");
+
+    std::size_t n_cases = 0;
+    std::string line_1, line_2;
+    while (std::getline(tle_file, line_1)) {
+        if (line_1[0] == '#') {
+            continue;
+        }
+        REQUIRE(std::getline(tle_file, line_2));
+        double startmfe, stopmfe, deltamin;
+        auto sat = sat_from_verif_tle(line_1, line_2, startmfe, stopmfe, deltamin);
+        REQUIRE(n_cases < ref_cases.size());
+        const ReferenceCase &ref = ref_cases[n_cases++];
+        const std::string satnum = sat.sat_rec.satnum;
+        CAPTURE(satnum);
+        REQUIRE(ref.satnum == satnum);
+
+        // Same steps as Vallado's driver, only keeping the times that propagate
+        // The driver prints the first row even if initialization failed, with
+        // whatever was left over from the previous case
+        const bool init_failed = (sat.last_error() != Sgp4Error::NONE);
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::array<double, 7>> rows;
+        StateVector sv;
+        double tsince = startmfe;
+        (void) sat.propagate_from_epoch(0.0, sv);
+        rows.push_back({ 0.0, sv.position[0], sv.position[1], sv.position[2],
+                         sv.velocity[0], sv.velocity[1], sv.velocity[2] });
+        if (std::fabs(tsince) > 1e-8) {
+            tsince -= deltamin;
+        }
+        while ((tsince < stopmfe) && sat.last_error() == Sgp4Error::NONE) {
+            tsince = std::min(tsince + deltamin, stopmfe);
+            if (sat.propagate_from_epoch(tsince, sv) == Sgp4Error::NONE) {
+                rows.push_back({ tsince, sv.position[0], sv.position[1], sv.position[2],
+                                 sv.velocity[0], sv.velocity[1], sv.velocity[2] });
+            }
+        }
+        const std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        ReferenceTolerance tolerance = DEFAULT_REFERENCE_TOLERANCE;
+        for (const auto &t : REFERENCE_TOLERANCES) {
+            if (satnum == t.satnum) {
+                tolerance = t;
+            }
+        }
+        // Errors stop a case at the same point as the reference
+        CHECK(rows.size() == ref.rows.size());
+        double max_position = 0.0, max_velocity = 0.0;
+        for (std::size_t k = 0; k < std::min(rows.size(), ref.rows.size()); ++k) {
+            CAPTURE(rows[k][0]);
+            CHECK(rows[k][0] == Approx(ref.rows[k][0]).epsilon(1e-8).scale(1.0));
+            if (k == 0 && init_failed) {
+                continue;
+            }
+            const Vec3 dr = { rows[k][1] - ref.rows[k][1], rows[k][2] - ref.rows[k][2],
+                              rows[k][3] - ref.rows[k][3] };
+            const Vec3 dv = { rows[k][4] - ref.rows[k][4], rows[k][5] - ref.rows[k][5],
+                              rows[k][6] - ref.rows[k][6] };
+            max_position = std::max(max_position, norm(dr));
+            max_velocity = std::max(max_velocity, norm(dv));
+        }
+        CHECK(max_position <= tolerance.position);
+        CHECK(max_velocity <= tolerance.velocity);
+
+        std::fprintf(
+            report,
+            "%s\n  {\"satnum\": \"%s\", \"points\": %zu, \"wall_time_us\": %.1f, "
+            "\"max_position_error_km\": %.3e, \"max_velocity_error_km_s\": %.3e, "
+            "\"position_tolerance_km\": %.3e, \"velocity_tolerance_km_s\": %.3e}",
+            (n_cases == 1) ? "" : ",", satnum.c_str(), rows.size(), elapsed.count(),
+            max_position, max_velocity, tolerance.position, tolerance.velocity
+        );
+    }
+    CHECK(n_cases == ref_cases.size());
+    std::fprintf(report, "\n]\n");
+    std::fclose(report);
+}
 #endif  // PERTURB_SGP4_ENABLE_DEBUG
 
 // FIXME: Expand this to test TLEs from other sources too!
@@ -545,3 +837,1605 @@ TEST_CASE(
     }
 }
 #endif  // PERTURB_SGP4_ENABLE_DEBUG
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_propagate_batch"
+    * doctest::description("Check batch propagation matches propagating one by one")
+) {
+    auto sats = load_verif_sats();
+    auto batch_sats = sats;
+    REQUIRE(!sats.empty());
+
+    for (const double days : { 0.0, 0.25, 3.0, -2.0, 40.0 }) {
+        CAPTURE(days);
+        const JulianDate jd = sats.front().epoch() + days;
+
+        std::vector<StateVector> batch_sv(sats.size());
+        std::vector<Sgp4Error> batch_err(sats.size());
+        const std::size_t n_failed = propagate_batch(
+            batch_sats.data(), batch_sats.size(), jd, batch_sv.data(), batch_err.data()
+        );
+
+        std::size_t n_expected_failed = 0;
+        for (std::size_t i = 0; i < sats.size(); ++i) {
+            CAPTURE(i);
+            StateVector sv {};
+            const auto err = sats[i].propagate(jd, sv);
+            CHECK(batch_err[i] == err);
+            CHECK(batch_sats[i].last_error() == err);
+            if (err != Sgp4Error::NONE) {
+                ++n_expected_failed;
+                continue;
+            }
+            CHECK(batch_sv[i].epoch.jd == sv.epoch.jd);
+            CHECK(batch_sv[i].epoch.jd_frac == sv.epoch.jd_frac);
+            CHECK(batch_sv[i].position == sv.position);
+            CHECK(batch_sv[i].velocity == sv.velocity);
+        }
+        CHECK(n_failed == n_expected_failed);
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_const_propagate"
+    * doctest::description("Check const propagation matches and doesn't modify")
+) {
+    auto sats = load_verif_sats();
+    const auto const_sats = sats;
+    REQUIRE(!sats.empty());
+
+    for (std::size_t i = 0; i < sats.size(); ++i) {
+        CAPTURE(i);
+        const Satellite &const_sat = const_sats[i];
+        sgp4::elsetrec rec_before;
+        std::memcpy(&rec_before, &const_sat.sat_rec, sizeof(rec_before));
+        sgp4::elsetrec_state state {};
+
+        // Go back and forth to exercise restarts of the deep-space integrator
+        for (const double days : { 0.0, 0.5, 3.0, 25.0, 2.0, -1.5, -10.0, 4.0 }) {
+            CAPTURE(days);
+            const JulianDate jd = sats[i].epoch() + days;
+            StateVector sv {}, const_sv {}, state_sv {};
+            const auto err = sats[i].propagate(jd, sv);
+            const auto const_err = const_sat.propagate(jd, const_sv);
+            const auto state_err = const_sat.propagate(jd, state_sv, state);
+
+            REQUIRE(const_err == err);
+            REQUIRE(state_err == err);
+            CHECK(state.t == sats[i].sat_rec.t);
+            if (err != Sgp4Error::NONE) {
+                continue;
+            }
+            CHECK(const_sv.epoch.jd == sv.epoch.jd);
+            CHECK(const_sv.epoch.jd_frac == sv.epoch.jd_frac);
+            CHECK(const_sv.position == sv.position);
+            CHECK(const_sv.velocity == sv.velocity);
+            CHECK(state_sv.position == sv.position);
+            CHECK(state_sv.velocity == sv.velocity);
+            CHECK(state.am == sats[i].sat_rec.am);
+            CHECK(state.mm == sats[i].sat_rec.mm);
+        }
+        // Nothing in the record should have changed
+        CHECK(std::memcmp(&rec_before, &const_sat.sat_rec, sizeof(rec_before)) == 0);
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_compact_record"
+    * doctest::description("Check propagating from the compact record is identical")
+) {
+    for (const auto &sat : load_verif_sats()) {
+        CAPTURE(sat.sat_rec.satnum);
+        sgp4::elsetrec_compact compact;
+        sgp4::compact_elsetrec(sat.sat_rec, compact);
+        sgp4::elsetrec_state state {}, compact_state {};
+
+        // Go back and forth to exercise restarts of the deep-space integrator
+        for (const double mins : { 0.0, 720.0, 4320.0, 1440.0, -2160.0, 36000.0 }) {
+            CAPTURE(mins);
+            double r[3], v[3], compact_r[3], compact_v[3];
+            const bool ok = sgp4::sgp4(sat.sat_rec, state, mins, r, v);
+            const bool compact_ok =
+                sgp4::sgp4(compact, compact_state, mins, compact_r, compact_v);
+            REQUIRE(compact_ok == ok);
+            REQUIRE(compact_state.error == state.error);
+            if (!ok) {
+                continue;
+            }
+            for (std::size_t k = 0; k < 3; ++k) {
+                CHECK(compact_r[k] == r[k]);
+                CHECK(compact_v[k] == v[k]);
+            }
+            CHECK(compact_state.xli == state.xli);
+            CHECK(compact_state.atime == state.atime);
+        }
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_satellite_catalog"
+    * doctest::description("Check the vectorized catalog kernel matches scalar SGP4")
+) {
+    auto sats = load_verif_sats();
+    auto catalog = SatelliteCatalog(sats);
+    REQUIRE(catalog.size() == sats.size());
+    CHECK(catalog.near_earth_size() > CATALOG_LANES);
+    CHECK(catalog.near_earth_size() < catalog.size());
+
+    for (const double days : { 0.0, 0.01, 0.5, 3.0, -1.5, 25.0, 400.0 }) {
+        CAPTURE(days);
+        const JulianDate jd = sats.front().epoch() + days;
+
+        std::vector<StateVector> cat_sv(catalog.size());
+        std::vector<Sgp4Error> cat_err(catalog.size());
+        const std::size_t n_failed =
+            catalog.propagate(jd, cat_sv.data(), cat_err.data());
+
+        std::size_t n_expected_failed = 0;
+        for (std::size_t i = 0; i < sats.size(); ++i) {
+            CAPTURE(i);
+            StateVector sv {};
+            const auto err = sats[i].propagate(jd, sv);
+            CHECK(cat_err[i] == err);
+            if (err != Sgp4Error::NONE) {
+                ++n_expected_failed;
+                continue;
+            }
+            CHECK(cat_sv[i].epoch.jd == jd.jd);
+            CHECK(cat_sv[i].epoch.jd_frac == jd.jd_frac);
+            const double pos_error = relative_error(cat_sv[i].position, sv.position);
+            const double vel_error = relative_error(cat_sv[i].velocity, sv.velocity);
+            CHECK(pos_error < CATALOG_REL_TOLERANCE);
+            CHECK(vel_error < CATALOG_REL_TOLERANCE);
+        }
+        CHECK(n_failed == n_expected_failed);
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_catalog_columns"
+    * doctest::description("Check propagating a catalog into columns")
+) {
+    const auto sats = load_verif_sats();
+    // Separate catalogs, since propagating keeps the deep-space states
+    auto catalog = SatelliteCatalog(sats);
+    auto col_catalog = catalog;
+    const std::size_t n = catalog.size();
+
+    for (const auto precision : { CatalogPrecision::DOUBLE, CatalogPrecision::MIXED }) {
+        for (const double days : { 0.0, 0.5, -1.5, 25.0 }) {
+            CAPTURE(days);
+            const JulianDate jd = sats.front().epoch() + days;
+            std::vector<StateVector> sv(n);
+            std::vector<Sgp4Error> err(n);
+            const auto n_failed =
+                catalog.propagate(jd, sv.data(), err.data(), precision);
+
+            // Structure-of-arrays, with every column
+            std::vector<double> soa(6 * n);
+            StateColumns cols;
+            cols.x = soa.data();
+            cols.y = cols.x + n;
+            cols.z = cols.y + n;
+            cols.vx = cols.z + n;
+            cols.vy = cols.vx + n;
+            cols.vz = cols.vy + n;
+            std::vector<Sgp4Error> col_err(n);
+            const auto n_col_failed =
+                col_catalog.propagate(jd, cols, col_err.data(), precision);
+            CHECK(n_col_failed == n_failed);
+            for (std::size_t i = 0; i < n; ++i) {
+                CAPTURE(i);
+                CHECK(col_err[i] == err[i]);
+                if (err[i] != Sgp4Error::NONE) {
+                    continue;
+                }
+                CHECK(cols.x[i] == sv[i].position[0]);
+                CHECK(cols.y[i] == sv[i].position[1]);
+                CHECK(cols.z[i] == sv[i].position[2]);
+                CHECK(cols.vx[i] == sv[i].velocity[0]);
+                CHECK(cols.vy[i] == sv[i].velocity[1]);
+                CHECK(cols.vz[i] == sv[i].velocity[2]);
+            }
+
+            // Interleaved rows, with only the positions
+            constexpr double UNTOUCHED = -1.0;
+            std::vector<double> rows(6 * n, UNTOUCHED);
+            StateColumns pos_cols;
+            pos_cols.x = rows.data();
+            pos_cols.y = rows.data() + 1;
+            pos_cols.z = rows.data() + 2;
+            pos_cols.stride = 6;
+            CHECK(col_catalog.propagate(jd, pos_cols, nullptr, precision) == n_failed);
+            for (std::size_t i = 0; i < n; ++i) {
+                CAPTURE(i);
+                if (err[i] == Sgp4Error::NONE) {
+                    CHECK(rows[6 * i] == sv[i].position[0]);
+                    CHECK(rows[6 * i + 1] == sv[i].position[1]);
+                    CHECK(rows[6 * i + 2] == sv[i].position[2]);
+                }
+                CHECK(rows[6 * i + 3] == UNTOUCHED);
+                CHECK(rows[6 * i + 4] == UNTOUCHED);
+                CHECK(rows[6 * i + 5] == UNTOUCHED);
+            }
+        }
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_catalog_mixed_precision"
+    * doctest::description("Check the mixed precision kernel stays close to double")
+) {
+    // Published error envelope of `CatalogPrecision::MIXED`
+    constexpr double MAX_POS_ERROR = 15e-3;  // [km]
+    constexpr double MAX_VEL_ERROR = 15e-6;  // [km/s]
+
+    // Go over each satellite's own verification time range
+    std::ifstream in_file("SGP4-VER.TLE");
+    REQUIRE_MESSAGE(in_file, "Ensure verification data file exists and is opened");
+    std::string line_1, line_2;
+    while (std::getline(in_file, line_1)) {
+        if (line_1[0] == '#') {
+            continue;
+        }
+        REQUIRE(std::getline(in_file, line_2));
+        std::istringstream range(line_2.substr(TLE_LINE_LEN));
+        double start_mins = 0.0, stop_mins = 0.0, step_mins = 0.0;
+        range >> start_mins >> stop_mins >> step_mins;
+        REQUIRE(!range.fail());
+        line_1.resize(TLE_LINE_LEN);
+        line_2.resize(TLE_LINE_LEN);
+        const auto sat = Satellite::from_tle(line_1, line_2);
+        if (sat.last_error() != Sgp4Error::NONE || sat.sat_rec.method != 'n') {
+            continue;
+        }
+        CAPTURE(sat.sat_rec.satnum);
+        auto catalog = SatelliteCatalog();
+        catalog.add(sat);
+        for (double mins = start_mins; mins <= stop_mins; mins += step_mins / 8.0) {
+            CAPTURE(mins);
+            const JulianDate jd = sat.epoch() + mins / 1440.0;
+            StateVector sv, mixed_sv;
+            Sgp4Error err, mixed_err;
+            (void) catalog.propagate(jd, &sv, &err);
+            (void) catalog.propagate(jd, &mixed_sv, &mixed_err, CatalogPrecision::MIXED);
+            REQUIRE(mixed_err == err);
+            if (err != Sgp4Error::NONE) {
+                continue;
+            }
+            Vec3 dr, dv;
+            for (std::size_t k = 0; k < 3; ++k) {
+                dr[k] = mixed_sv.position[k] - sv.position[k];
+                dv[k] = mixed_sv.velocity[k] - sv.velocity[k];
+            }
+            CHECK(norm(dr) < MAX_POS_ERROR);
+            CHECK(norm(dv) < MAX_VEL_ERROR);
+        }
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+/// Check the compile-time gravity constants match the runtime ones exactly
+template <GravModel Model>
+void check_grav_constants(const sgp4::gravconsttype which) {
+    double tumin, mus, radiusearthkm, xke, j2, j3, j4, j3oj2;
+    sgp4::getgravconst(which, tumin, mus, radiusearthkm, xke, j2, j3, j4, j3oj2);
+    CHECK(GravConstants<Model>::tumin() == tumin);
+    CHECK(GravConstants<Model>::mus() == mus);
+    CHECK(GravConstants<Model>::radiusearthkm() == radiusearthkm);
+    CHECK(GravConstants<Model>::xke() == xke);
+    CHECK(GravConstants<Model>::j2() == j2);
+    CHECK(GravConstants<Model>::j3() == j3);
+    CHECK(GravConstants<Model>::j4() == j4);
+    CHECK(GravConstants<Model>::j3oj2() == j3oj2);
+}
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_catalog_grav_models"
+    * doctest::description("Check the catalog kernel specialized on a gravity model")
+) {
+    check_grav_constants<GravModel::WGS72_OLD>(sgp4::wgs72old);
+    check_grav_constants<GravModel::WGS72>(sgp4::wgs72);
+    check_grav_constants<GravModel::WGS84>(sgp4::wgs84);
+
+    GravModel model = GravModel::WGS72_OLD;
+    CHECK(!SatelliteCatalog().grav_model(model));
+
+    const auto wgs84_sats = load_verif_sats(GravModel::WGS84);
+    auto uniform = SatelliteCatalog(wgs84_sats);
+    REQUIRE(uniform.grav_model(model));
+    CHECK(model == GravModel::WGS84);
+
+    // Adding a different model falls back to the columns for every satellite
+    auto sats = wgs84_sats;
+    auto mixed = uniform;
+    for (const auto &sat : load_verif_sats(GravModel::WGS72)) {
+        sats.push_back(sat);
+        mixed.add(sat);
+    }
+    CHECK(!mixed.grav_model(model));
+
+    for (const auto *catalog : { &uniform, &mixed }) {
+        for (const double days : { 0.0, 0.5, 3.0, -1.5 }) {
+            CAPTURE(days);
+            const JulianDate jd = sats.front().epoch() + days;
+            std::vector<StateVector> cat_sv(catalog->size());
+            std::vector<Sgp4Error> cat_err(catalog->size());
+            (void) catalog->propagate_grid(
+                0, catalog->size(), &jd, 1, cat_sv.data(), cat_err.data()
+            );
+            for (std::size_t i = 0; i < catalog->size(); ++i) {
+                CAPTURE(i);
+                StateVector sv {};
+                const auto err = sats[i].propagate(jd, sv);
+                REQUIRE(cat_err[i] == err);
+                if (err == Sgp4Error::NONE) {
+                    const double pos_error =
+                        relative_error(cat_sv[i].position, sv.position);
+                    const double vel_error =
+                        relative_error(cat_sv[i].velocity, sv.velocity);
+                    CHECK(pos_error < CATALOG_REL_TOLERANCE);
+                    CHECK(vel_error < CATALOG_REL_TOLERANCE);
+                }
+            }
+        }
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#if !defined(PERTURB_DISABLE_IO) && !defined(PERTURB_DISABLE_THREADS)
+TEST_CASE(
+    "test_parallel_propagator"
+    * doctest::description("Check multi-threaded propagation matches a single thread")
+) {
+    // Few enough satellite tasks that the times are split up too
+    const auto verif_sats = load_verif_sats();
+    auto catalog = SatelliteCatalog();
+    while (catalog.size() < 3 * PARALLEL_TASK_SATS + 20) {
+        catalog.add(verif_sats[catalog.size() % verif_sats.size()]);
+    }
+    std::vector<JulianDate> times;
+    for (std::size_t k = 0; k < 69; ++k) {
+        times.push_back(verif_sats.front().epoch() + 0.01 * static_cast<double>(k));
+    }
+    const std::size_t n_out = catalog.size() * times.size();
+
+    std::vector<StateVector> grid_sv(n_out);
+    std::vector<Sgp4Error> grid_err(n_out);
+    const std::size_t grid_failed = catalog.propagate_grid(
+        0, catalog.size(), times.data(), times.size(), grid_sv.data(), grid_err.data()
+    );
+
+    for (const std::size_t n_threads : { 1U, 3U }) {
+        CAPTURE(n_threads);
+        ParallelPropagator propagator(n_threads);
+        REQUIRE(propagator.thread_count() == n_threads);
+
+        std::vector<StateVector> out_sv(n_out);
+        std::vector<Sgp4Error> out_err(n_out);
+        // Run twice to make sure the pool can be reused
+        for (int run = 0; run < 2; ++run) {
+            const std::size_t n_failed = propagator.propagate(
+                catalog, times.data(), times.size(), out_sv.data(), out_err.data()
+            );
+            CHECK(n_failed == grid_failed);
+        }
+        for (std::size_t j = 0; j < n_out; ++j) {
+            CAPTURE(j);
+            REQUIRE(out_err[j] == grid_err[j]);
+            if (out_err[j] == Sgp4Error::NONE) {
+                CHECK(out_sv[j].position == grid_sv[j].position);
+                CHECK(out_sv[j].velocity == grid_sv[j].velocity);
+            }
+        }
+    }
+
+    // The single-threaded grid should match propagating the catalog directly
+    for (std::size_t k = 0; k < times.size(); ++k) {
+        CAPTURE(k);
+        std::vector<StateVector> cat_sv(catalog.size());
+        std::vector<Sgp4Error> cat_err(catalog.size());
+        (void) catalog.propagate(times[k], cat_sv.data(), cat_err.data());
+        for (std::size_t i = 0; i < catalog.size(); ++i) {
+            const std::size_t j = k * catalog.size() + i;
+            REQUIRE(cat_err[i] == grid_err[j]);
+            if (cat_err[i] == Sgp4Error::NONE) {
+                CHECK(cat_sv[i].position == grid_sv[j].position);
+                CHECK(cat_sv[i].velocity == grid_sv[j].velocity);
+            }
+        }
+    }
+}
+#endif  // !defined(PERTURB_DISABLE_IO) && !defined(PERTURB_DISABLE_THREADS)
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_propagate_range"
+    * doctest::description("Check evenly spaced propagation matches one at a time")
+) {
+    const auto sats = load_verif_sats();
+    REQUIRE(!sats.empty());
+
+    constexpr std::size_t COUNT = 200;
+    for (const double step_sec : { 10.0, -600.0, 3600.0 }) {
+        CAPTURE(step_sec);
+        for (std::size_t i = 0; i < sats.size(); ++i) {
+            CAPTURE(i);
+            const Satellite &sat = sats[i];
+            const JulianDate start = sat.epoch() - 0.2;
+            std::vector<StateVector> range_sv(COUNT);
+            std::size_t n_valid = COUNT + 1;
+            const auto range_err =
+                sat.propagate_range(start, step_sec, COUNT, range_sv.data(), &n_valid);
+            REQUIRE(n_valid <= COUNT);
+
+            for (std::size_t k = 0; k < n_valid; ++k) {
+                CAPTURE(k);
+                const JulianDate jd =
+                    start + static_cast<double>(k) * step_sec / 86400.0;
+                StateVector sv {};
+                REQUIRE(sat.propagate(jd, sv) == Sgp4Error::NONE);
+                CHECK(range_sv[k].epoch.jd == jd.jd);
+                CHECK(range_sv[k].epoch.jd_frac == doctest::Approx(jd.jd_frac));
+                CHECK_VEC(range_sv[k].position, sv.position, 1e-9, 1000);
+                CHECK_VEC(range_sv[k].velocity, sv.velocity, 1e-9, 10);
+            }
+            if (n_valid < COUNT) {
+                CHECK(range_err != Sgp4Error::NONE);
+                StateVector sv {};
+                const JulianDate jd =
+                    start + static_cast<double>(n_valid) * step_sec / 86400.0;
+                CHECK(sat.propagate(jd, sv) == range_err);
+            } else {
+                CHECK(range_err == Sgp4Error::NONE);
+            }
+        }
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_resonance_checkpoints"
+    * doctest::description("Check resuming from checkpoints matches plain propagation")
+) {
+    const auto sats = load_verif_sats();
+    std::size_t n_resonant = 0;
+
+    for (std::size_t i = 0; i < sats.size(); ++i) {
+        CAPTURE(i);
+        const Satellite &sat = sats[i];
+        const bool is_resonant = (sat.sat_rec.method == 'd' && sat.sat_rec.irez != 0);
+        n_resonant += is_resonant ? 1U : 0U;
+
+        ResonanceCheckpoints checkpoints;
+        sgp4::elsetrec_state state {};
+        // Out of order and far enough to fill up and thin out the checkpoints
+        for (const double days : { 30.0, 2.0, -45.0, 700.0, 3.3, -0.2, 9000.0, 40.0 }) {
+            CAPTURE(days);
+            const JulianDate jd = sat.epoch() + days;
+            StateVector sv {}, ck_sv {};
+            const auto err = sat.propagate(jd, sv);
+            const auto ck_err = sat.propagate(jd, ck_sv, state, checkpoints);
+            REQUIRE(ck_err == err);
+            if (err != Sgp4Error::NONE) {
+                continue;
+            }
+            CHECK(ck_sv.position == sv.position);
+            CHECK(ck_sv.velocity == sv.velocity);
+        }
+        if (is_resonant) {
+            CHECK(checkpoints.size() > 0U);
+            CHECK(checkpoints.size() <= 2 * RESONANCE_CHECKPOINTS);
+        } else {
+            CHECK(checkpoints.size() == 0U);
+        }
+    }
+    CHECK(n_resonant > 0U);
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_tle_reader"
+    * doctest::description("Check bulk loading of TLE files and buffers")
+) {
+    SUBCASE("test_verif_file") {
+        const auto ref_sats = load_verif_sats();
+        const TleReader reader("SGP4-VER.TLE");
+        REQUIRE(reader.is_open());
+        REQUIRE(reader.size() == ref_sats.size());
+
+        for (const std::size_t n_threads : { 1U, 3U }) {
+            CAPTURE(n_threads);
+            std::vector<Satellite> sats;
+            std::vector<TleReadResult> results;
+            const std::size_t n_failed =
+                reader.read(sats, results, GravModel::WGS72, n_threads);
+            REQUIRE(results.size() == ref_sats.size());
+            CHECK(sats.size() + n_failed == results.size());
+            CHECK(sats.size() > ref_sats.size() / 2);
+
+            std::size_t next_index = 0;
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                CAPTURE(i);
+                const TleReadResult &res = results[i];
+                CHECK(res.name.empty());
+                if (res.sat_index == TLE_NOT_LOADED) {
+                    CHECK(
+                        (res.parse_error != TLEParseError::NONE
+                         || res.init_error != Sgp4Error::NONE)
+                    );
+                    continue;
+                }
+                // Loaded satellites are kept in file order
+                REQUIRE(res.sat_index == next_index);
+                ++next_index;
+                const Satellite &sat = sats[res.sat_index];
+                CHECK(sat.sat_rec.satnum == ref_sats[i].sat_rec.satnum);
+                for (const double mins : { 0.0, 30.0, 1440.0 }) {
+                    StateVector sv_a {}, sv_b {};
+                    const auto err_a = sat.propagate_from_epoch(mins, sv_a);
+                    const auto err_b = ref_sats[i].propagate_from_epoch(mins, sv_b);
+                    CHECK(err_a == err_b);
+                    CHECK_VEC(sv_a.position, sv_b.position, 1e-14, 1000);
+                    CHECK_VEC(sv_a.velocity, sv_b.velocity, 1e-14, 10);
+                }
+            }
+        }
+
+        const auto catalog = SatelliteCatalog::load("SGP4-VER.TLE");
+        std::vector<Satellite> sats;
+        std::vector<TleReadResult> results;
+        const std::size_t n_failed = reader.read(sats, results);
+        CHECK(catalog.size() == results.size() - n_failed);
+    }
+
+    SUBCASE("test_buffer_formats") {
+        const std::string text =
+            "ISS (ZARYA)             \r\n"
+            "1 25544U 98067A   22071.78032407  .00021395  00000-0  39008-3 0  9996\r\n"
+            "2 25544  51.6424  94.0370 0004047 256.5103  89.8846 15.49386383330227\r\n"
+            "\n"
+            "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753\n"
+            "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667\n"
+            "0 VANGUARD 1\n"
+            "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4750\n"
+            "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667\n"
+            "# Missing its second line\n"
+            "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753\n"
+            "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667\n"
+            "1 25544U 98067A   22071.78032407  .00021395  00000-0  39008-3 0  9996\n"
+            "NO LINE 2\n"
+            "2 25544  51.6424  94.0370 0004047 256.5103  89.8846 15.49386383330227";
+        const TleReader reader(text.data(), text.size());
+        REQUIRE(reader.is_open());
+        REQUIRE(reader.size() == 6U);
+
+        std::vector<Satellite> sats;
+        std::vector<TleReadResult> results;
+        CHECK(reader.read(sats, results) == 3U);
+        REQUIRE(sats.size() == 3U);
+        REQUIRE(results.size() == 6U);
+
+        CHECK(results[0].line_number == 2U);
+        CHECK(results[0].name == "ISS (ZARYA)");
+        CHECK(results[0].parse_error == TLEParseError::NONE);
+        CHECK(results[0].init_error == Sgp4Error::NONE);
+        CHECK(results[0].sat_index == 0U);
+        CHECK(sats[0].sat_rec.satnum == "25544");
+
+        CHECK(results[1].line_number == 5U);
+        CHECK(results[1].name.empty());
+        CHECK(results[1].sat_index == 1U);
+
+        CHECK(results[2].line_number == 8U);
+        CHECK(results[2].name == "VANGUARD 1");
+        CHECK(results[2].parse_error == TLEParseError::CHECKSUM_MISMATCH);
+        CHECK(results[2].init_error == Sgp4Error::INVALID_TLE);
+        CHECK(results[2].sat_index == TLE_NOT_LOADED);
+
+        // Comments aren't names
+        CHECK(results[3].line_number == 11U);
+        CHECK(results[3].name.empty());
+        CHECK(results[3].sat_index == 2U);
+        CHECK(sats[2].sat_rec.satnum == "00005");
+
+        CHECK(results[4].line_number == 13U);
+        CHECK(results[4].parse_error == TLEParseError::INVALID_FORMAT);
+        CHECK(results[4].sat_index == TLE_NOT_LOADED);
+
+        // Stray second line, which also doesn't make the line before it a name
+        CHECK(results[5].line_number == 15U);
+        CHECK(results[5].name.empty());
+        CHECK(results[5].parse_error == TLEParseError::INVALID_FORMAT);
+    }
+
+    SUBCASE("test_missing_file") {
+        const TleReader reader("does-not-exist.tle");
+        CHECK(!reader.is_open());
+        CHECK(reader.size() == 0U);
+        CHECK(SatelliteCatalog::load("does-not-exist.tle").size() == 0U);
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_init_satellites"
+    * doctest::description("Check multi-threaded init matches the Satellite constructor")
+) {
+    std::ifstream in_file("SGP4-VER.TLE");
+    REQUIRE_MESSAGE(in_file, "Ensure verification data file exists and is opened");
+    std::vector<TwoLineElement> verif_tles;
+    std::string line_1, line_2;
+    while (std::getline(in_file, line_1)) {
+        if (line_1[0] == '#') {
+            continue;
+        }
+        REQUIRE(std::getline(in_file, line_2));
+        TwoLineElement tle {};
+        if (tle.parse(line_1, line_2) == TLEParseError::NONE) {
+            verif_tles.push_back(tle);
+        }
+    }
+    REQUIRE(!verif_tles.empty());
+
+    // Enough TLEs for several blocks per thread
+    std::vector<TwoLineElement> tles;
+    while (tles.size() < 200) {
+        tles.push_back(verif_tles[tles.size() % verif_tles.size()]);
+    }
+
+    for (const std::size_t n_threads : { 1U, 3U }) {
+        CAPTURE(n_threads);
+        const auto existing = Satellite(tles.front());
+        std::vector<Satellite> sats(1, existing);
+        std::vector<Sgp4Error> errs(tles.size());
+        const std::size_t n_failed = init_satellites(
+            tles.data(), tles.size(), sats, errs.data(), GravModel::WGS72, n_threads
+        );
+        REQUIRE(sats.size() == tles.size() + 1);
+
+        std::size_t n_expected_failed = 0;
+        for (std::size_t i = 0; i < tles.size(); ++i) {
+            CAPTURE(i);
+            const auto sat = Satellite(tles[i]);
+            const Satellite &sat_init = sats[i + 1];
+            CHECK(errs[i] == sat.last_error());
+            CHECK(sat_init.last_error() == sat.last_error());
+            n_expected_failed += (sat.last_error() != Sgp4Error::NONE) ? 1U : 0U;
+
+            StateVector sv_a {}, sv_b {};
+            const auto err_a = sat_init.propagate_from_epoch(720.0, sv_a);
+            const auto err_b = sat.propagate_from_epoch(720.0, sv_b);
+            CHECK(err_a == err_b);
+            CHECK(sv_a.position == sv_b.position);
+            CHECK(sv_a.velocity == sv_b.velocity);
+        }
+        CHECK(n_failed == n_expected_failed);
+    }
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_snapshot"
+    * doctest::description("Check snapshots round-trip and reject bad files")
+) {
+    const char *PATH = "test-snapshot.bin";
+    const auto sats = load_verif_sats();
+    REQUIRE(write_snapshot(PATH, sats.data(), sats.size()) == SnapshotError::NONE);
+
+    // Read the file back to corrupt it in various ways
+    std::string contents;
+    {
+        std::ifstream in_file(PATH, std::ios::binary);
+        contents.assign(
+            (std::istreambuf_iterator<char>(in_file)), std::istreambuf_iterator<char>()
+        );
+    }
+    REQUIRE(contents.size() == 64 + sats.size() * sizeof(Satellite));
+    const auto open_modified = [&](const std::string &modified) {
+        std::ofstream(PATH, std::ios::binary | std::ios::trunc) << modified;
+        Snapshot snap;
+        const auto err = snap.open(PATH);
+        CHECK(snap.size() == 0U);
+        return err;
+    };
+
+    SUBCASE("test_round_trip") {
+        Snapshot snap;
+        REQUIRE(snap.open(PATH) == SnapshotError::NONE);
+        REQUIRE(snap.size() == sats.size());
+        for (std::size_t i = 0; i < sats.size(); ++i) {
+            CAPTURE(i);
+            CHECK(std::memcmp(&snap[i], &sats[i], sizeof(Satellite)) == 0);
+            for (const double mins : { 0.0, 720.0, -1440.0 }) {
+                StateVector sv_a {}, sv_b {};
+                const JulianDate jd = sats[i].epoch() + mins / 1440.0;
+                const auto err_a = snap.satellites()[i].propagate(jd, sv_a);
+                CHECK(err_a == sats[i].propagate(jd, sv_b));
+                CHECK(sv_a.position == sv_b.position);
+                CHECK(sv_a.velocity == sv_b.velocity);
+            }
+        }
+
+        // Empty snapshots are fine too
+        CHECK(write_snapshot(PATH, nullptr, 0) == SnapshotError::NONE);
+        CHECK(snap.open(PATH) == SnapshotError::NONE);
+        CHECK(snap.size() == 0U);
+    }
+
+    SUBCASE("test_grav_model") {
+        CHECK(
+            write_snapshot(PATH, sats.data(), sats.size(), GravModel::WGS84)
+            == SnapshotError::GRAV_MODEL_MISMATCH
+        );
+        Snapshot snap;
+        const auto err = snap.open(PATH, GravModel::WGS72_OLD);
+        CHECK(err == SnapshotError::GRAV_MODEL_MISMATCH);
+        CHECK(snap.size() == 0U);
+    }
+
+    SUBCASE("test_bad_files") {
+        Snapshot snap;
+        CHECK(snap.open("does-not-exist.bin") == SnapshotError::CANNOT_OPEN);
+        CHECK(snap.open("SGP4-VER.TLE") == SnapshotError::BAD_MAGIC);
+
+        std::string modified = contents;
+        modified[8] = static_cast<char>(modified[8] + 1);  // Endian tag
+        CHECK(open_modified(modified) == SnapshotError::ENDIAN_MISMATCH);
+
+        modified = contents;
+        modified[12] = static_cast<char>(modified[12] + 1);  // Format version
+        CHECK(open_modified(modified) == SnapshotError::VERSION_MISMATCH);
+
+        modified = contents;
+        modified[16] = static_cast<char>(modified[16] + 8);  // Record size
+        CHECK(open_modified(modified) == SnapshotError::VERSION_MISMATCH);
+
+        CHECK(open_modified("") == SnapshotError::TRUNCATED);
+        CHECK(open_modified(contents.substr(0, 4)) == SnapshotError::TRUNCATED);
+        CHECK(open_modified(contents.substr(0, 40)) == SnapshotError::TRUNCATED);
+        CHECK(
+            open_modified(contents.substr(0, contents.size() - 1))
+            == SnapshotError::TRUNCATED
+        );
+
+        modified = contents;
+        modified[64 + sizeof(Satellite) + 100] ^= 1;
+        CHECK(open_modified(modified) == SnapshotError::CHECKSUM_MISMATCH);
+        CHECK(snap.open(PATH, GravModel::WGS72, false) == SnapshotError::NONE);
+        CHECK(snap.size() == sats.size());
+    }
+    std::remove(PATH);
+}
+#endif  // PERTURB_DISABLE_IO
+
+TEST_CASE(
+    "test_frames"
+    * doctest::description("Check TEME to ECEF and geodetic against known values")
+) {
+    const double RAD_PER_DEG = std::acos(-1.0) / 180.0;
+    const double RAD_PER_ARCSEC = RAD_PER_DEG / 3600.0;
+
+    // TEME example from "Revisiting Spacetrack Report #3"
+    StateVector sv {};
+    sv.epoch = JulianDate(DateTime { 2004, 4, 6, 7, 51, 28.386009 });
+    sv.position = { { 5094.18016210, 6127.64465950, 6380.34453270 } };
+    sv.velocity = { { -4.746131487, 0.785818041, 5.531931288 } };
+    const EarthOrientation eop {
+        -0.140682 * RAD_PER_ARCSEC, 0.333309 * RAD_PER_ARCSEC, -0.4399619
+    };
+
+    SUBCASE("test_to_ecef") {
+        // Without polar motion, this is the PEF frame
+        const auto pef = to_ecef(sv, EarthOrientation { 0.0, 0.0, eop.ut1_utc });
+        CHECK(pef.epoch.jd == sv.epoch.jd);
+        CHECK(pef.epoch.jd_frac == sv.epoch.jd_frac);
+        const Vec3 pef_pos = { { -1033.4750313, 7901.3055856, 6380.3445327 } };
+        const Vec3 pef_vel = { { -3.225632747, -2.872442511, 5.531931288 } };
+        CHECK_VEC(pef.position, pef_pos, 1e-9, 1);
+        // The reference also has length of day in the Earth's rotation rate
+        CHECK_VEC(pef.velocity, pef_vel, 1e-8, 1);
+
+        const auto ecef = to_ecef(sv, eop);
+        const Vec3 ecef_pos = { { -1033.4793830, 7901.2952754, 6380.3565958 } };
+        const Vec3 ecef_vel = { { -3.225636520, -2.872451450, 5.531924446 } };
+        CHECK_VEC(ecef.position, ecef_pos, 1e-9, 1);
+        CHECK_VEC(ecef.velocity, ecef_vel, 1e-8, 1);
+
+        const EarthRotation rot(sv.epoch, eop);
+        CHECK(rot.rotate(sv.position) == ecef.position);
+        const auto rot_ecef = rot.to_ecef(sv);
+        CHECK(rot_ecef.position == ecef.position);
+        CHECK(rot_ecef.velocity == ecef.velocity);
+    }
+
+    SUBCASE("test_batch") {
+        // Three satellites at one time, then two at another
+        std::vector<StateVector> svs(5, sv);
+        for (std::size_t i = 0; i < svs.size(); ++i) {
+            svs[i].position[0] += 100.0 * static_cast<double>(i);
+            svs[i].epoch += (i < 3) ? 0.0 : 0.25;
+        }
+        EopTable table;
+        table.add(53101.0, eop);
+        table.add(53102.0, eop);
+        std::vector<EcefState> out(svs.size());
+        std::vector<Geodetic> out_geo(svs.size());
+        to_ecef(svs.data(), svs.size(), out.data(), &table);
+        to_geodetic(svs.data(), svs.size(), out_geo.data(), &table);
+        for (std::size_t i = 0; i < svs.size(); ++i) {
+            CAPTURE(i);
+            const auto expected = to_ecef(svs[i], eop);
+            CHECK(out[i].position == expected.position);
+            CHECK(out[i].velocity == expected.velocity);
+            const auto geo = to_geodetic(svs[i], eop);
+            CHECK(out_geo[i].latitude == geo.latitude);
+            CHECK(out_geo[i].longitude == geo.longitude);
+            CHECK(out_geo[i].altitude == geo.altitude);
+        }
+        to_ecef(svs.data(), 0, nullptr);
+    }
+
+    SUBCASE("test_rotation_cache") {
+        EopTable table;
+        table.add(53101.0, eop);
+        table.add(53102.0, EarthOrientation { eop.xp, eop.yp, eop.ut1_utc - 1e-3 });
+        EarthRotationCache cache(&table);
+        const auto check_same = [&](const EarthRotation &rot, const JulianDate jd) {
+            CHECK(rot.epoch().jd == jd.jd);
+            CHECK(rot.epoch().jd_frac == jd.jd_frac);
+            const auto expected = EarthRotation(jd, table.at(jd)).to_ecef(sv);
+            const auto ecef = rot.to_ecef(sv);
+            CHECK(relative_error(ecef.position, expected.position) < 1e-8);
+            CHECK(relative_error(ecef.velocity, expected.velocity) < 1e-8);
+        };
+
+        // Only computed once per time point
+        CHECK(cache.n_evaluations() == 0U);
+        check_same(cache.at(sv.epoch), sv.epoch);
+        check_same(cache.at(sv.epoch), sv.epoch);
+        CHECK(cache.n_evaluations() == 1U);
+        const auto later = sv.epoch + 0.5;
+        check_same(cache.at(later), later);
+        CHECK(cache.n_evaluations() == 2U);
+
+        // Stepped at 1 Hz over a few resyncs, and backwards by minutes, which
+        // also starts over on each of the two days it moves into
+        for (const double step : { 1.0, -60.0 }) {
+            CAPTURE(step);
+            const std::size_t n_steps = 3 * EARTH_ROTATION_RESYNC_STEPS + 10;
+            const std::size_t evaluations = cache.n_evaluations();
+            check_same(cache.begin_steps(sv.epoch, step), sv.epoch);
+            double max_gmst_error = 0.0;
+            for (std::size_t k = 1; k <= n_steps; ++k) {
+                const auto jd = sv.epoch + static_cast<double>(k) * (step / 86400.0);
+                const EarthRotation &rot = cache.next_step();
+                const double exact = EarthRotation(jd, table.at(jd)).gmst();
+                double error = std::fabs(rot.gmst() - exact);
+                error = std::min(error, std::fabs(error - 2 * std::acos(-1.0)));
+                max_gmst_error = std::max(max_gmst_error, error);
+                if (k % 100 == 0) {
+                    check_same(rot, jd);
+                }
+            }
+            CHECK(max_gmst_error < 1e-8);
+            CHECK(cache.n_evaluations() == evaluations + ((step > 0.0) ? 4 : 6));
+        }
+
+        // Looking up another time in between starts the steps over
+        const std::size_t evaluations = cache.n_evaluations();
+        cache.begin_steps(sv.epoch, 1.0);
+        cache.at(later);
+        check_same(cache.next_step(), sv.epoch + 1.0 / 86400.0);
+        CHECK(cache.n_evaluations() == evaluations + 3);
+    }
+
+    SUBCASE("test_geodetic") {
+        // Example 3-3 from Vallado's "Fundamentals of Astrodynamics"
+        const auto geo = to_geodetic(Vec3 { { 6524.834, 6862.875, 6448.296 } });
+        CHECK(geo.latitude == Approx(34.352496 * RAD_PER_DEG).epsilon(1e-7));
+        CHECK(geo.longitude == Approx(46.4464 * RAD_PER_DEG).epsilon(1e-5));
+        CHECK(geo.altitude == Approx(5085.22).epsilon(1e-6));
+
+        // Round trip from the poles to the equator, from the surface to the Moon
+        for (int lat_deg = -90; lat_deg <= 90; lat_deg += 5) {
+            for (const double alt : { -5.0, 0.0, 0.5, 400.0, 36000.0, 400000.0 }) {
+                CAPTURE(lat_deg);
+                CAPTURE(alt);
+                const double lon = 1.9 * lat_deg * RAD_PER_DEG;
+                const Geodetic in { lat_deg * RAD_PER_DEG, lon, alt };
+                const Geodetic out = to_geodetic(to_ecef(in));
+                CHECK(out.latitude == Approx(in.latitude).scale(1).epsilon(1e-14));
+                CHECK(out.altitude == Approx(in.altitude).scale(1).epsilon(1e-9));
+                if (std::abs(lat_deg) != 90) {
+                    CHECK(out.longitude == Approx(in.longitude).scale(1).epsilon(1e-14));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(
+    "test_eop_table" * doctest::description("Check interpolating Earth orientation")
+) {
+    EopTable table;
+    CHECK(table.at(JulianDate(2451545.0)).ut1_utc == 0.0);
+
+    // Around the leap second at the end of 2016
+    table.add(57752.0, EarthOrientation { 1e-6, 2e-6, -0.5 });
+    table.add(57753.0, EarthOrientation { 3e-6, 4e-6, 0.4 });
+    REQUIRE(table.size() == 2U);
+    const auto mid = table.at(JulianDate(2400000.5 + 57752.0, 0.5));
+    CHECK(mid.xp == Approx(2e-6));
+    CHECK(mid.yp == Approx(3e-6));
+    CHECK(mid.ut1_utc == Approx(-0.55));  // Not half way through the jump
+    CHECK(table.at(JulianDate(2400000.5, 50000.0)).ut1_utc == -0.5);
+    CHECK(table.at(JulianDate(2400000.5, 60000.0)).ut1_utc == 0.4);
+
+#ifndef PERTURB_DISABLE_IO
+    // A few rows in the IERS `finals2000A.all` format, with a blank last row
+    const char *PATH = "test-finals.all";
+    std::ofstream(PATH)
+        << "161230 57752.00 I  0.034569 0.000055  0.278823 0.000036  I-0.4062310 "
+           "0.0000093  1.5037 0.0068  I     0.214    0.143     0.064    0.160\n"
+           "161231 57753.00 I  0.032716 0.000055  0.279379 0.000038  I-0.4077370 "
+           "0.0000085  1.5225 0.0060  I     0.220    0.143     0.059    0.160\n"
+           "17 1 1 57754.00 I  0.030988 0.000060  0.279911 0.000040  I 0.5907410 "
+           "0.0000081  1.6195 0.0065  I     0.232    0.143     0.064    0.160\n"
+           "17 1 2 57755.00                                                      \n";
+    EopTable loaded;
+    REQUIRE(loaded.load(PATH));
+    REQUIRE(loaded.size() == 3U);
+    const auto row = loaded.at(JulianDate(2400000.5 + 57753.0));
+    CHECK(row.xp == Approx(0.032716 * 4.84813681109536e-6));
+    CHECK(row.yp == Approx(0.279379 * 4.84813681109536e-6));
+    CHECK(row.ut1_utc == Approx(-0.4077370));
+    const auto leap = loaded.at(JulianDate(2400000.5 + 57753.0, 0.5));
+    CHECK(leap.ut1_utc == Approx(-0.408498));
+    CHECK_FALSE(loaded.load("does-not-exist.all"));
+    CHECK_FALSE(loaded.load("SGP4-VER.TLE"));
+    CHECK(loaded.size() == 3U);
+    std::remove(PATH);
+#endif  // PERTURB_DISABLE_IO
+}
+
+TEST_CASE(
+    "test_ground_station" * doctest::description("Check look angles for known geometry")
+) {
+    const double PI = std::acos(-1.0);
+    const double RAD_PER_DEG = PI / 180.0;
+    const GroundStation station(Geodetic { 0.0, 0.0, 0.0 }, 10.0 * RAD_PER_DEG);
+    CHECK(station.position() == Vec3 { { WGS84_RADIUS, 0.0, 0.0 } });
+    CHECK(station.zenith() == Vec3 { { 1.0, 0.0, 0.0 } });
+    CHECK(station.min_elevation() == 10.0 * RAD_PER_DEG);
+
+    EcefState sat {};
+    // Straight overhead, moving away
+    sat.position = { { WGS84_RADIUS + 500.0, 0.0, 0.0 } };
+    sat.velocity = { { 1.0, 7.0, 0.0 } };
+    auto look = station.look_at(sat);
+    CHECK(look.elevation == Approx(PI / 2));
+    CHECK(look.range == Approx(500.0));
+    CHECK(look.range_rate == Approx(1.0));
+    CHECK(station.is_visible(sat.position));
+
+    // On the horizon to the north, moving towards the station
+    sat.position = { { WGS84_RADIUS, 0.0, 1000.0 } };
+    sat.velocity = { { 0.0, 0.0, -2.0 } };
+    look = station.look_at(sat);
+    CHECK(look.azimuth == Approx(0.0).scale(1));
+    CHECK(look.elevation == Approx(0.0).scale(1));
+    CHECK(look.range == Approx(1000.0));
+    CHECK(look.range_rate == Approx(-2.0));
+    CHECK_FALSE(station.is_visible(sat.position));
+
+    // At 45 degrees of elevation to the east, and the same to the west
+    sat.position = { { WGS84_RADIUS + 1000.0, 1000.0, 0.0 } };
+    look = station.look_at(sat);
+    CHECK(look.azimuth == Approx(PI / 2));
+    CHECK(look.elevation == Approx(PI / 4));
+    CHECK(station.is_visible(sat.position));
+    sat.position[1] = -1000.0;
+    CHECK(station.look_at(sat).azimuth == Approx(3 * PI / 2));
+
+    // Just below and above the elevation mask
+    const double el = 10.0 * RAD_PER_DEG;
+    for (const double delta : { -1e-9, 1e-9 }) {
+        const double up = 1000.0 * std::sin(el + delta);
+        sat.position = { { WGS84_RADIUS + up, 0.0, 1000.0 * std::cos(el + delta) } };
+        CHECK(station.is_visible(sat.position) == (delta > 0));
+    }
+
+    const Vec3 sez = station.to_sez(Vec3 { { 1.0, 2.0, 3.0 } });
+    CHECK(sez == Vec3 { { -3.0, 2.0, 1.0 } });
+}
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_station_network"
+    * doctest::description("Check all-pairs look angles match looking one at a time")
+) {
+    const double RAD_PER_DEG = std::acos(-1.0) / 180.0;
+    // Include satellites that fail, which have to be skipped
+    auto sats = load_verif_sats();
+    std::vector<Satellite> valid;
+    for (const auto &sat : sats) {
+        if (sat.last_error() == Sgp4Error::NONE) {
+            valid.push_back(sat);
+        }
+    }
+    SatelliteCatalog catalog(valid);
+
+    std::vector<GroundStation> stations;
+    for (int i = 0; i < 12; ++i) {
+        const Geodetic loc {
+            (-75.0 + 13.0 * i) * RAD_PER_DEG, (-170.0 + 29.0 * i) * RAD_PER_DEG, 0.1 * i
+        };
+        stations.emplace_back(loc, (i % 3) * 5.0 * RAD_PER_DEG);
+    }
+    StationNetwork network(stations);
+    network.add(GroundStation(Geodetic { 0.5, 0.5, 0.0 }, -0.1));
+    REQUIRE(network.size() == 13U);
+
+    std::vector<StateVector> sv(catalog.size());
+    std::vector<Sgp4Error> err(catalog.size());
+    std::vector<EcefState> ecef(catalog.size());
+    std::vector<Visibility> vis, vis_ecef;
+    std::size_t n_visible = 0;
+    for (int k = 0; k < 20; ++k) {
+        vis.clear();
+        vis_ecef.clear();
+        const JulianDate jd = catalog[0].epoch() + 0.37 * k;
+        (void) catalog.propagate(jd, sv.data(), err.data());
+        const std::size_t n = network.look_angles(sv.data(), sv.size(), err.data(), vis);
+        REQUIRE(n == vis.size());
+        n_visible += n;
+
+        // Brute force over every pair, in the same order
+        const EarthRotation rot(jd);
+        std::size_t next = 0;
+        for (std::size_t s = 0; s < network.size(); ++s) {
+            for (std::size_t i = 0; i < sv.size(); ++i) {
+                ecef[i] = rot.to_ecef(sv[i]);
+                if (err[i] != Sgp4Error::NONE
+                    || !network[s].is_visible(ecef[i].position)) {
+                    continue;
+                }
+                CAPTURE(s);
+                CAPTURE(i);
+                REQUIRE(next < vis.size());
+                CHECK(vis[next].station == s);
+                CHECK(vis[next].satellite == i);
+                const auto look = network[s].look_at(ecef[i]);
+                CHECK(vis[next].look.azimuth == look.azimuth);
+                CHECK(vis[next].look.elevation == look.elevation);
+                CHECK(vis[next].look.elevation >= network[s].min_elevation() - 1e-12);
+                CHECK(vis[next].look.range == look.range);
+                CHECK(vis[next].look.range_rate == look.range_rate);
+                ++next;
+            }
+        }
+        CHECK(next == vis.size());
+
+        // Without errors, the ECEF overload gives the same pairs
+        std::vector<EcefState> ok;
+        std::vector<std::size_t> ok_idx;
+        for (std::size_t i = 0; i < sv.size(); ++i) {
+            if (err[i] == Sgp4Error::NONE) {
+                ok.push_back(ecef[i]);
+                ok_idx.push_back(i);
+            }
+        }
+        REQUIRE(network.look_angles(ok.data(), ok.size(), vis_ecef) == vis.size());
+        for (std::size_t j = 0; j < vis.size(); ++j) {
+            CHECK(vis_ecef[j].station == vis[j].station);
+            CHECK(ok_idx[vis_ecef[j].satellite] == vis[j].satellite);
+            CHECK(vis_ecef[j].look.elevation == vis[j].look.elevation);
+        }
+    }
+    CHECK(n_visible > 0U);
+}
+#endif  // PERTURB_DISABLE_IO
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_find_passes"
+    * doctest::description("Check passes against scanning elevation every 2 seconds")
+) {
+    const double RAD_PER_DEG = std::acos(-1.0) / 180.0;
+    constexpr double SCAN_STEP = 2.0;
+    const auto sats = load_verif_sats();
+    const GroundStation station(Geodetic { 0.8, -1.3, 0.1 }, 5.0 * RAD_PER_DEG);
+
+    std::size_t n_passes = 0;
+    for (std::size_t k = 0; k < sats.size(); k += 3) {
+        CAPTURE(k);
+        const Satellite &sat = sats[k];
+        const JulianDate start = sat.epoch() + 0.3;
+        const JulianDate end = start + 1.0;
+        std::vector<Pass> passes;
+        std::size_t n_evals = 0;
+        const auto err = find_passes(sat, station, start, end, passes, &n_evals);
+
+        // Brute force scan, noting the samples either side of each pass
+        struct Scanned {
+            double aos, los, max_elevation;
+        };
+        std::vector<Scanned> scanned;
+        Sgp4Error scan_err = sat.last_error();
+        bool in_pass = false;
+        for (double t = 0.0; t <= 86400.0; t += SCAN_STEP) {
+            if (scan_err != Sgp4Error::NONE) {
+                break;
+            }
+            const JulianDate jd = start + t / 86400.0;
+            StateVector sv;
+            scan_err = sat.propagate(jd, sv);
+            if (scan_err != Sgp4Error::NONE) {
+                break;
+            }
+            const auto look = station.look_at(EarthRotation(jd).to_ecef(sv));
+            const bool visible = look.elevation >= station.min_elevation();
+            if (visible && !in_pass) {
+                scanned.push_back(Scanned { t, 86400.0, look.elevation });
+            }
+            if (visible) {
+                scanned.back().max_elevation =
+                    std::max(scanned.back().max_elevation, look.elevation);
+            } else if (in_pass) {
+                scanned.back().los = t;
+            }
+            in_pass = visible;
+        }
+        CHECK(err == scan_err);
+        if (err != Sgp4Error::NONE) {
+            CHECK(n_evals <= 1U);
+            continue;
+        }
+        CHECK(n_evals < static_cast<std::size_t>(86400.0 / SCAN_STEP / 50));
+        REQUIRE(passes.size() == scanned.size());
+        n_passes += passes.size();
+        for (std::size_t i = 0; i < passes.size(); ++i) {
+            CAPTURE(i);
+            const Pass &pass = passes[i];
+            const double aos = (pass.aos - start) * 86400.0;
+            const double tca = (pass.tca - start) * 86400.0;
+            const double los = (pass.los - start) * 86400.0;
+            CHECK(aos <= tca);
+            CHECK(tca <= los);
+            // The scan only sees the first sample in or after the pass
+            CHECK(aos <= scanned[i].aos + PASS_TIME_TOLERANCE);
+            CHECK(aos >= scanned[i].aos - SCAN_STEP);
+            CHECK(los <= scanned[i].los);
+            CHECK(los >= scanned[i].los - SCAN_STEP - PASS_TIME_TOLERANCE);
+            CHECK(pass.max_elevation >= scanned[i].max_elevation - 1e-7);
+
+            // The edges are right on the mask, unless clipped to the window
+            StateVector sv;
+            REQUIRE(sat.propagate(pass.aos, sv) == Sgp4Error::NONE);
+            const auto look = station.look_at(EarthRotation(pass.aos).to_ecef(sv));
+            if (i > 0 || aos > 0.0) {
+                CHECK(look.elevation == Approx(station.min_elevation()).epsilon(1e-4));
+            }
+        }
+    }
+    CHECK(n_passes > 10U);
+}
+
+TEST_CASE(
+    "test_network_passes"
+    * doctest::description("Check network passes match each pair on its own")
+) {
+    const auto sats = load_verif_sats();
+    std::vector<Satellite> valid;
+    for (const auto &sat : sats) {
+        if (sat.last_error() == Sgp4Error::NONE) {
+            valid.push_back(sat);
+        }
+    }
+    StationNetwork network;
+    network.add(GroundStation(Geodetic { 0.8, -1.3, 0.1 }, 0.1));
+    network.add(GroundStation(Geodetic { -0.5, 2.5, 0.0 }));
+    const JulianDate start = valid[0].epoch();
+    const JulianDate end = start + 0.5;
+
+    std::vector<StationPass> out;
+    const std::size_t n_failed =
+        network.find_passes(valid.data(), valid.size(), start, end, out, 3);
+    std::size_t next = 0, n_expected_failed = 0;
+    for (std::size_t i = 0; i < valid.size(); ++i) {
+        bool failed = false;
+        for (std::size_t s = 0; s < network.size(); ++s) {
+            std::vector<Pass> passes;
+            failed |= find_passes(valid[i], network[s], start, end, passes)
+                != Sgp4Error::NONE;
+            for (const Pass &pass : passes) {
+                REQUIRE(next < out.size());
+                CHECK(out[next].station == s);
+                CHECK(out[next].satellite == i);
+                CHECK(out[next].pass.aos - pass.aos == 0.0);
+                CHECK(out[next].pass.tca - pass.tca == 0.0);
+                CHECK(out[next].pass.los - pass.los == 0.0);
+                CHECK(out[next].pass.max_elevation == pass.max_elevation);
+                ++next;
+            }
+        }
+        n_expected_failed += failed ? 1 : 0;
+    }
+    CHECK(next == out.size());
+    CHECK(n_failed == n_expected_failed);
+}
+#endif  // PERTURB_DISABLE_IO
+
+/// Satellite on a near-circular orbit, with an epoch of 2022-04-10 12:00
+static Satellite make_orbit_sat(
+    const double inclination, const double raan, const double mean_anomaly,
+    const double mean_motion
+) {
+    TwoLineElement tle {};
+    std::strcpy(tle.catalog_number, "99999");
+    tle.classification = 'U';
+    tle.epoch_year = 22U;
+    tle.epoch_day_of_year = 100.5;
+    tle.b_star = 1e-5;
+    tle.inclination = inclination;
+    tle.raan = raan;
+    tle.eccentricity = 0.001;
+    tle.arg_of_perigee = 0.0;
+    tle.mean_anomaly = mean_anomaly;
+    tle.mean_motion = mean_motion;
+    return Satellite(tle);
+}
+
+TEST_CASE(
+    "test_screen_conjunctions"
+    * doctest::description("Check screening finds every close approach of a scan")
+) {
+    // Crossing orbits all around 700 km, plus one pair built to meet at their
+    // shared node at epoch (apart from short-period terms that differ with
+    // inclination), and a geostationary satellite far from the rest
+    std::vector<Satellite> sats;
+    sats.push_back(make_orbit_sat(50.0, 10.0, 0.0, 14.6));
+    sats.push_back(make_orbit_sat(80.0, 10.0, 0.0, 14.6));
+    sats.push_back(make_orbit_sat(0.05, 0.0, 0.0, 1.0027));
+    std::uint32_t seed = 12345;
+    const auto uniform = [&seed](const double lo, const double hi) {
+        seed = seed * 1664525U + 1013904223U;
+        return lo + (hi - lo) * static_cast<double>(seed >> 8) / 16777216.0;
+    };
+    while (sats.size() < 42U) {
+        const double inclination = uniform(40.0, 100.0);
+        const double raan = uniform(0.0, 360.0);
+        const double mean_anomaly = uniform(0.0, 360.0);
+        const double mean_motion = uniform(14.55, 14.65);
+        sats.push_back(make_orbit_sat(inclination, raan, mean_anomaly, mean_motion));
+    }
+    const SatelliteCatalog catalog(sats);
+    const JulianDate start = sats[0].epoch();
+    const JulianDate end = start + 0.25;
+    const double threshold = 25.0;
+
+    std::vector<Conjunction> out;
+    CHECK(screen_conjunctions(catalog, start, end, threshold, out, 30.0, 1) == 0U);
+    REQUIRE(!out.empty());
+
+    SUBCASE("test_refined") {
+        const auto range_at = [&](const Conjunction &conj, const double offset_secs) {
+            const JulianDate jd = conj.tca + offset_secs / 86400.0;
+            StateVector a, b;
+            REQUIRE(sats[conj.sat_a].propagate(jd, a) == Sgp4Error::NONE);
+            REQUIRE(sats[conj.sat_b].propagate(jd, b) == Sgp4Error::NONE);
+            const double dx = b.position[0] - a.position[0];
+            const double dy = b.position[1] - a.position[1];
+            const double dz = b.position[2] - a.position[2];
+            return std::sqrt(dx * dx + dy * dy + dz * dz);
+        };
+        bool found_node_pair = false;
+        for (std::size_t k = 0; k < out.size(); ++k) {
+            const Conjunction &conj = out[k];
+            CHECK(conj.sat_a < conj.sat_b);
+            CHECK(conj.miss_distance <= threshold);
+            CHECK(conj.miss_distance == Approx(range_at(conj, 0.0)));
+            CHECK(range_at(conj, -0.01) >= conj.miss_distance - 1e-6);
+            CHECK(range_at(conj, 0.01) >= conj.miss_distance - 1e-6);
+            CHECK(start <= conj.tca);
+            CHECK(conj.tca <= end);
+            if (k > 0) {
+                CHECK(out[k - 1].tca <= conj.tca);
+            }
+            found_node_pair |= conj.sat_a == 0U && conj.sat_b == 1U
+                && conj.tca - start < 1.0 / 1440.0 && conj.miss_distance < 5.0;
+        }
+        CHECK(found_node_pair);
+    }
+
+    SUBCASE("test_brute_force") {
+        // Every local minimum of distance under the threshold in a 2 s scan of
+        // every pair should have been found, at least as close. Also with a
+        // step of a third of an orbit, which is too long to screen directly.
+        std::vector<Conjunction> coarse;
+        const std::size_t n_coarse_errors =
+            screen_conjunctions(catalog, start, end, threshold, coarse, 1800.0, 1);
+        CHECK(n_coarse_errors == 0U);
+        const double step = 2.0 / 86400.0;
+        const auto n_steps = static_cast<std::size_t>((end - start) / step) + 1;
+        std::vector<StateVector> grid(n_steps * sats.size());
+        for (std::size_t k = 0; k < n_steps; ++k) {
+            for (std::size_t i = 0; i < sats.size(); ++i) {
+                const JulianDate jd = start + static_cast<double>(k) * step;
+                StateVector &sv = grid[k * sats.size() + i];
+                REQUIRE(sats[i].propagate(jd, sv) == Sgp4Error::NONE);
+            }
+        }
+        const auto was_found = [&](const std::vector<Conjunction> &found, std::size_t a,
+                                   std::size_t b, JulianDate t, double d) {
+            for (const Conjunction &conj : found) {
+                if (conj.sat_a == a && conj.sat_b == b && std::fabs(conj.tca - t) <= step
+                    && conj.miss_distance <= d + 1e-9) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        std::size_t n_expected = 0;
+        std::vector<double> dist(n_steps);
+        for (std::size_t a = 0; a < sats.size(); ++a) {
+            for (std::size_t b = a + 1; b < sats.size(); ++b) {
+                for (std::size_t k = 0; k < n_steps; ++k) {
+                    const Vec3 &pa = grid[k * sats.size() + a].position;
+                    const Vec3 &pb = grid[k * sats.size() + b].position;
+                    const double dx = pb[0] - pa[0], dy = pb[1] - pa[1];
+                    const double dz = pb[2] - pa[2];
+                    dist[k] = std::sqrt(dx * dx + dy * dy + dz * dz);
+                }
+                for (std::size_t k = 0; k < n_steps; ++k) {
+                    const bool is_min = dist[k] <= threshold
+                        && (k == 0 || dist[k] <= dist[k - 1])
+                        && (k + 1 == n_steps || dist[k] <= dist[k + 1]);
+                    if (!is_min) {
+                        continue;
+                    }
+                    ++n_expected;
+                    const JulianDate t = start + static_cast<double>(k) * step;
+                    INFO("Pair ", a, " and ", b, " at step ", k, ", ", dist[k], " km");
+                    CHECK(was_found(out, a, b, t, dist[k]));
+                    CHECK(was_found(coarse, a, b, t, dist[k]));
+                }
+            }
+        }
+        CHECK(n_expected == out.size());
+        CHECK(n_expected == coarse.size());
+    }
+
+    SUBCASE("test_threads") {
+        std::vector<Conjunction> threaded;
+        screen_conjunctions(catalog, start, end, threshold, threaded, 30.0, 3);
+        REQUIRE(threaded.size() == out.size());
+        for (std::size_t k = 0; k < out.size(); ++k) {
+            CHECK(threaded[k].sat_a == out[k].sat_a);
+            CHECK(threaded[k].sat_b == out[k].sat_b);
+            CHECK(threaded[k].tca - out[k].tca == 0.0);
+            CHECK(threaded[k].miss_distance == out[k].miss_distance);
+        }
+    }
+
+    SUBCASE("test_step_size") {
+        // Larger steps check more pairs each step, but find the same approaches
+        std::vector<Conjunction> coarse;
+        screen_conjunctions(catalog, start, end, threshold, coarse, 120.0, 1);
+        REQUIRE(coarse.size() == out.size());
+        for (std::size_t k = 0; k < out.size(); ++k) {
+            CHECK(coarse[k].sat_a == out[k].sat_a);
+            CHECK(coarse[k].sat_b == out[k].sat_b);
+            CHECK(std::fabs(coarse[k].tca - out[k].tca) * 86400.0 < 0.01);
+            CHECK(coarse[k].miss_distance == Approx(out[k].miss_distance));
+        }
+    }
+}
+
+/// Check an ephemeris against direct propagation, inside and outside its window
+static void check_ephemeris(const Ephemeris &eph, const double max_error) {
+    const Satellite &sat = eph.satellite();
+    const double vel_error = max_error * sat.sat_rec.no_kozai / 60.0;
+    const double span = eph.end() - eph.start();
+    constexpr int N_QUERIES = 2000;
+    for (int k = 0; k <= N_QUERIES; ++k) {
+        // Slightly uneven, so that queries land all over the segments
+        const double frac = (k + 0.37 * std::sin(k * 1.7)) / N_QUERIES;
+        const JulianDate jd = eph.start() + span * std::fmin(1.0, std::fmax(0.0, frac));
+        StateVector interp, direct;
+        REQUIRE(eph.propagate(jd, interp) == Sgp4Error::NONE);
+        REQUIRE(sat.propagate(jd, direct) == Sgp4Error::NONE);
+        CHECK(interp.epoch - jd == 0.0);
+        const Vec3 dr { { interp.position[0] - direct.position[0],
+                          interp.position[1] - direct.position[1],
+                          interp.position[2] - direct.position[2] } };
+        const Vec3 dv { { interp.velocity[0] - direct.velocity[0],
+                          interp.velocity[1] - direct.velocity[1],
+                          interp.velocity[2] - direct.velocity[2] } };
+        CHECK(norm(dr) <= max_error);
+        CHECK(norm(dv) <= vel_error);
+    }
+    // Outside the window is exactly the satellite
+    for (const JulianDate jd : { eph.start() - 0.01, eph.end() + 0.01 }) {
+        StateVector interp, direct;
+        const Sgp4Error err = eph.propagate(jd, interp);
+        CHECK(err == sat.propagate(jd, direct));
+        if (err == Sgp4Error::NONE) {
+            CHECK(interp.position == direct.position);
+            CHECK(interp.velocity == direct.velocity);
+        }
+    }
+    // Times from epoch go through the same lookup
+    const double mins = (eph.start() - sat.epoch()) * 1440.0 + span * 720.0;
+    StateVector from_epoch, at_time;
+    REQUIRE(eph.propagate_from_epoch(mins, from_epoch) == Sgp4Error::NONE);
+    REQUIRE(eph.propagate(sat.epoch() + mins / 1440.0, at_time) == Sgp4Error::NONE);
+    CHECK(from_epoch.epoch - at_time.epoch == 0.0);
+    CHECK_VEC(from_epoch.position, at_time.position, 1e-12, 1.0);
+}
+
+TEST_CASE(
+    "test_ephemeris"
+    * doctest::description("Check interpolated ephemerides against propagation")
+) {
+    SUBCASE("test_error_bound") {
+        const Satellite sat = make_orbit_sat(51.6, 30.0, 45.0, 15.5);
+        for (const double max_error : { 1e-2, 1e-3, 1e-5 }) {
+            const Ephemeris eph(sat, sat.epoch(), sat.epoch() + 0.5, max_error);
+            CHECK(eph.last_error() == Sgp4Error::NONE);
+            CHECK(eph.end() - (sat.epoch() + 0.5) == Approx(0.0));
+            INFO("Max error ", max_error, " km with ", eph.size(), " segments");
+            check_ephemeris(eph, max_error);
+        }
+        // Tighter bounds need more, shorter segments
+        const Ephemeris loose(sat, sat.epoch(), sat.epoch() + 0.5, 1e-2);
+        const Ephemeris tight(sat, sat.epoch(), sat.epoch() + 0.5, 1e-5);
+        CHECK(loose.size() < tight.size());
+    }
+
+    SUBCASE("test_empty_window") {
+        const Satellite sat = make_orbit_sat(51.6, 30.0, 45.0, 15.5);
+        const Ephemeris eph(sat, sat.epoch(), sat.epoch());
+        CHECK(eph.size() == 0U);
+        StateVector interp, direct;
+        CHECK(eph.propagate(sat.epoch() + 0.1, interp) == Sgp4Error::NONE);
+        CHECK(sat.propagate(sat.epoch() + 0.1, direct) == Sgp4Error::NONE);
+        CHECK(interp.position == direct.position);
+    }
+
+#ifndef PERTURB_DISABLE_IO
+    SUBCASE("test_verif_sats") {
+        // Every kind of orbit, including ones that error or decay partway
+        for (const auto &sat : load_verif_sats()) {
+            if (sat.last_error() != Sgp4Error::NONE) {
+                continue;
+            }
+            const JulianDate start = sat.epoch() - 0.25;
+            const Ephemeris eph(sat, start, start + 1.25);
+            INFO("Satellite ", sat.sat_rec.satnum, " with ", eph.size(), " segments");
+            CHECK(eph.end() <= start + 1.25);
+            if (eph.last_error() == Sgp4Error::NONE && eph.end() < start + 1.25) {
+                // Cut short without an error only where SGP4 can't be fit
+                CHECK(sat.sat_rec.ecco > 0.99);
+            }
+            check_ephemeris(eph, 1e-3);
+        }
+    }
+#endif  // PERTURB_DISABLE_IO
+}
+
+#ifndef PERTURB_DISABLE_IO
+TEST_CASE(
+    "test_propagation_stats"
+    * doctest::description("Check the optional statistics count what SGP4 runs into")
+) {
+    const auto sats = load_verif_sats();
+    SatelliteCatalog catalog(sats);
+    std::vector<StateVector> sv(catalog.size());
+    std::vector<Sgp4Error> err(catalog.size());
+    // Far from most epochs, so resonant satellites integrate for a while
+    const JulianDate jd = sats[0].epoch() + 30.0;
+
+    reset_thread_stats();
+    catalog.propagate(jd, sv.data(), err.data());
+    const PropagationStats stats = thread_stats();
+    PropagationStats sat_stats;
+    if (!STATS_ENABLED) {
+        CHECK(stats.n_propagations == 0U);
+        CHECK(stats.kepler_iterations == 0U);
+        CHECK_FALSE(catalog.stats(0, sat_stats));
+        return;
+    }
+
+    // Each satellite's counters add up to the thread's
+    CHECK(stats.n_propagations == catalog.size());
+    CHECK(stats.kepler_iterations >= catalog.size());
+    CHECK(stats.dspace_steps > 0U);
+    CHECK(stats.lyddane > 0U);
+    PropagationStats total;
+    for (std::size_t i = 0; i < catalog.size(); ++i) {
+        CAPTURE(i);
+        REQUIRE(catalog.stats(i, sat_stats));
+        CHECK(sat_stats.n_propagations == 1U);
+        CHECK(sat_stats.errors[static_cast<std::size_t>(err[i])] == 1U);
+        total += sat_stats;
+    }
+    CHECK(total.n_propagations == stats.n_propagations);
+    CHECK(total.kepler_iterations == stats.kepler_iterations);
+    CHECK(total.kepler_capped == stats.kepler_capped);
+    CHECK(total.dspace_steps == stats.dspace_steps);
+    CHECK(total.lyddane == stats.lyddane);
+    CHECK(total.propagate_nanos == stats.propagate_nanos);
+    for (std::size_t k = 0; k < N_SGP4_ERRORS; ++k) {
+        CHECK(total.errors[k] == stats.errors[k]);
+    }
+    catalog.reset_stats();
+    REQUIRE(catalog.stats(0, sat_stats));
+    CHECK(sat_stats.n_propagations == 0U);
+
+    // The catalog's Kepler solver needs fewer iterations than the scalar one,
+    // which matters most for highly eccentric orbits
+    (void) catalog.propagate(jd, sv.data(), err.data());
+    std::uint64_t scalar_iterations = 0, batched_iterations = 0;
+    for (std::size_t i = 0; i < catalog.size(); ++i) {
+        if (sats[i].sat_rec.ecco < 0.5 || err[i] != Sgp4Error::NONE) {
+            continue;
+        }
+        reset_thread_stats();
+        StateVector out;
+        (void) sats[i].propagate(jd, out);
+        scalar_iterations += thread_stats().kepler_iterations;
+        REQUIRE(catalog.stats(i, sat_stats));
+        batched_iterations += sat_stats.kepler_iterations;
+    }
+    CHECK(batched_iterations > 0U);
+    CHECK(4 * batched_iterations < 3 * scalar_iterations);
+
+    for (std::size_t i = 0; i < sats.size(); ++i) {
+        const Satellite &sat = sats[i];
+        if (sat.sat_rec.irez == 0 || sat.last_error() != Sgp4Error::NONE) {
+            continue;
+        }
+        CAPTURE(sat.sat_rec.satnum);
+        // One resonance step for every 720 minutes, carrying on with the state
+        constexpr std::uint64_t STEPS_PER_DAY = 2;
+        reset_thread_stats();
+        sgp4::elsetrec_state state {};
+        StateVector out;
+        (void) sat.propagate(sat.epoch() + 10.0, out, state);
+        CHECK(thread_stats().n_propagations == 1U);
+        CHECK(thread_stats().dspace_steps == 10 * STEPS_PER_DAY);
+        (void) sat.propagate(sat.epoch() + 10.5, out, state);
+        CHECK(thread_stats().dspace_steps == 10 * STEPS_PER_DAY + 1);
+    }
+
+    // Initializing also propagates to epoch once
+    std::string line_1 =
+        "1 88888U          80275.98708465  .00073094  13844-3  66816-4 0    87";
+    std::string line_2 =
+        "2 88888  72.8435 115.9689 0086731  52.6988 110.5714 16.05824518  1058";
+    reset_thread_stats();
+    const Satellite sat = Satellite::from_tle(line_1, line_2);
+    REQUIRE(sat.last_error() == Sgp4Error::NONE);
+    CHECK(thread_stats().n_inits == 1U);
+    CHECK(thread_stats().n_propagations == 1U);
+    CHECK(thread_stats().errors[0] == 1U);
+}
+#endif  // PERTURB_DISABLE_IO